@@ -1,4 +0,0 @@
-SELECT name
-FROM ducklings
-ORDER BY age DESC, name ASC
-LIMIT 1;
@@ -1,4 +0,0 @@
-SELECT name
-FROM ducklings
-ORDER BY age ASC, name ASC
-LIMIT 4;
@@ -1,3 +0,0 @@
-SELECT COUNT(*) AS count
-FROM ducklings
-WHERE color = 'yellow';
@@ -1,4 +0,0 @@
-SELECT name
-FROM ducklings
-WHERE color IN ('yellow', 'brown')
-ORDER BY name ASC;
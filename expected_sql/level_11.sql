@@ -1,4 +0,0 @@
-SELECT name
-FROM ducklings
-WHERE name LIKE 'D%'
-ORDER BY name ASC;
@@ -1,5 +0,0 @@
-SELECT name
-FROM ducklings
-WHERE age BETWEEN 2 AND 4
-ORDER BY age ASC, name ASC
-LIMIT 5;
@@ -0,0 +1,134 @@
+#!/usr/bin/python3
+"""
+Generates the per-level dojo_check benchmarks in benchmark/dojo/ from spec/tasks.json.
+
+Every level gets a correct submission (its expected_sql) and an incorrect one (the same query without its first row),
+both on the starter dataset and on a generated dataset of one million ducklings. check_many_sf1.benchmark grades all of
+those submissions in one dojo_check_many call. The verdict cache and plan equivalence are switched off, so every run
+executes the submissions instead of reusing the first run's verdicts or passing them on their plan alone. The files use
+the format of DuckDB's benchmark runner; the remaining benchmarks in benchmark/dojo/ are written by hand. Re-run after
+editing a task:
+
+    python3 scripts/generate_benchmarks.py
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+DEFAULT_SPEC = ROOT / "spec" / "tasks.json"
+DEFAULT_OUTPUT = ROOT / "benchmark" / "dojo"
+
+# Subdirectory -> (dojo_setup arguments, description of the dataset)
+DATASETS = {
+    "check": ("", "the 12-row starter dataset"),
+    "check_sf1": ("scale_factor := 1", "a generated dataset of one million ducklings"),
+}
+
+# Settings of every generated benchmark: each run executes the submission afresh
+LOAD_SETTINGS = "SET dojo_verdict_cache_size = 0;\nSET dojo_plan_equivalence = false;"
+
+
+def fail(message: str):
+    print(f"generate_benchmarks.py: {message}", file=sys.stderr)
+    sys.exit(1)
+
+
+def statement(sql: str) -> str:
+    """The task's expected_sql on one line, without its trailing semicolon."""
+    sql = " ".join(line.strip() for line in sql.strip().splitlines())
+    if sql.endswith(";"):
+        sql = sql[:-1].rstrip()
+    if "$$" in sql:
+        fail(f"expected_sql may not contain $$: {sql}")
+    return sql
+
+
+def submission(task: dict, correct: bool) -> str:
+    sql = statement(task["expected_sql"])
+    if correct:
+        return sql
+    # One row short of the canonical answer, so the whole result is still read and compared
+    return f"SELECT * FROM ({sql}) AS submission OFFSET 1"
+
+
+def benchmark(path: str, task: dict, dataset: str, correct: bool) -> str:
+    setup_args, dataset_description = DATASETS[dataset]
+    kind = "correct" if correct else "incorrect"
+    article = "a" if correct else "an"
+    return f"""# name: {path}
+# description: dojo_check of {article} {kind} submission for level {task['level']} on {dataset_description}
+# group: [{dataset}]
+
+name Dojo {dataset} level {task['level']:02d} ({kind})
+group dojo
+subgroup {dataset}
+
+require dojo
+
+load
+{LOAD_SETTINGS}
+SELECT * FROM dojo_setup({setup_args});
+
+run
+SELECT ok FROM dojo_check({task['task_id']}, $${submission(task, correct)}$$);
+
+result I
+{'true' if correct else 'false'}
+"""
+
+
+def check_many_benchmark(tasks: list) -> str:
+    rows = []
+    for task in tasks:
+        for correct in (True, False):
+            submission_id = len(rows) + 1
+            sql = submission(task, correct).replace("'", "''")
+            rows.append(f"({submission_id}, {task['task_id']}, '{sql}')")
+    return f"""# name: benchmark/dojo/check_many_sf1.benchmark
+# description: dojo_check_many grading a correct and an incorrect submission per level on one million ducklings
+# group: [dojo]
+
+name Dojo check_many ({len(rows)} submissions, sf1)
+group dojo
+
+require dojo
+
+load
+{LOAD_SETTINGS}
+SELECT * FROM dojo_setup(scale_factor := 1);
+CREATE TABLE submissions(submission_id INTEGER, task_id INTEGER, sql VARCHAR);
+INSERT INTO submissions VALUES {", ".join(rows)};
+
+run
+SELECT count(*), count(*) FILTER (WHERE ok) FROM dojo_check_many((SELECT submission_id, task_id, sql FROM submissions));
+
+result II
+{len(rows)}	{len(tasks)}
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the dojo_check benchmarks from spec/tasks.json")
+    parser.add_argument("--spec", type=Path, default=DEFAULT_SPEC)
+    parser.add_argument("--output", type=Path, default=DEFAULT_OUTPUT, help="benchmark/dojo directory")
+    args = parser.parse_args()
+
+    tasks = sorted(json.loads(args.spec.read_text(encoding="utf-8")), key=lambda t: t["task_id"])
+    for dataset in DATASETS:
+        directory = args.output / dataset
+        directory.mkdir(parents=True, exist_ok=True)
+        for stale in directory.glob("*.benchmark"):
+            stale.unlink()
+        for task in tasks:
+            for correct in (True, False):
+                file_name = f"level_{task['level']:02d}_{'correct' if correct else 'incorrect'}.benchmark"
+                path = f"benchmark/dojo/{dataset}/{file_name}"
+                (directory / file_name).write_text(benchmark(path, task, dataset, correct), encoding="utf-8")
+    (args.output / "check_many_sf1.benchmark").write_text(check_many_benchmark(tasks), encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
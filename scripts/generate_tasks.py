@@ -0,0 +1,305 @@
+#!/usr/bin/python3
+"""
+Generates the built-in task registry of the dojo extension from spec/tasks.json.
+
+The output header holds a constexpr task table, the canonical result of every task on the starter dataset (so built-in
+levels can be graded without running their expected_sql first) and the starter dataset rows read from
+spec/ducklings.sql. The extension copies the task table into its runtime task catalog, which packs can replace; a
+compile-time perfect hash from task_id to table index finds the canonical result of a built-in task.
+
+Canonical results are read from spec/expected_results.json. Each entry records the expected_sql and the dataset
+script it was computed from, and generation fails when either has changed since. Refresh the file with
+--refresh-results, which needs the duckdb Python module:
+
+    python3 scripts/generate_tasks.py --refresh-results
+"""
+
+import argparse
+import hashlib
+import json
+import re
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+DEFAULT_SPEC = ROOT / "spec" / "tasks.json"
+DEFAULT_RESULTS = ROOT / "spec" / "expected_results.json"
+DEFAULT_DATASET = ROOT / "spec" / "ducklings.sql"
+
+# Multiplier of the perfect hash; must match TaskSlot() in the generated header
+HASH_MULTIPLIER = 0x9E3779B1
+MAX_SEED = 1 << 20
+
+
+def fail(message: str):
+    print(f"generate_tasks.py: {message}", file=sys.stderr)
+    sys.exit(1)
+
+
+def load_tasks(spec_path: Path) -> list:
+    tasks = json.loads(spec_path.read_text(encoding="utf-8"))
+    seen = set()
+    for task in tasks:
+        for key in ("task_id", "level", "title", "expected_columns", "expected_sql"):
+            if key not in task:
+                fail(f"{spec_path}: task {task.get('task_id', '?')} is missing '{key}'")
+        if task["task_id"] in seen:
+            fail(f"{spec_path}: duplicate task_id {task['task_id']}")
+        seen.add(task["task_id"])
+    return sorted(tasks, key=lambda t: t["task_id"])
+
+
+def dataset_hash(dataset_path: Path) -> str:
+    return hashlib.sha256(dataset_path.read_bytes()).hexdigest()
+
+
+# One row of the INSERT in spec/ducklings.sql: ('name', 'color', age)
+DUCKLING_ROW = re.compile(r"\(\s*'((?:[^']|'')*)'\s*,\s*'((?:[^']|'')*)'\s*,\s*(-?\d+)\s*\)")
+
+
+def load_ducklings(dataset_path: Path) -> list:
+    text = dataset_path.read_text(encoding="utf-8")
+    values = text.split("VALUES", 1)
+    if len(values) != 2:
+        fail(f"{dataset_path}: no INSERT ... VALUES statement")
+    rows = [
+        (name.replace("''", "'"), color.replace("''", "'"), int(age))
+        for name, color, age in DUCKLING_ROW.findall(values[1].split(";", 1)[0])
+    ]
+    if not rows:
+        fail(f"{dataset_path}: no duckling rows")
+    return rows
+
+
+def refresh_results(tasks: list, dataset_path: Path, results_path: Path):
+    try:
+        import duckdb
+    except ImportError:
+        fail("--refresh-results needs the duckdb Python module (pip install duckdb)")
+
+    con = duckdb.connect()
+    con.execute(dataset_path.read_text(encoding="utf-8"))
+    results = {"dataset_sha256": dataset_hash(dataset_path), "tasks": {}}
+    for task in tasks:
+        query = task["expected_sql"].strip().rstrip(";")
+        described = con.execute(f"DESCRIBE {query}").fetchall()
+        names = [row[0] for row in described]
+        types = [row[1] for row in described]
+        casts = ", ".join(f"CAST(\"{name}\" AS VARCHAR)" for name in names)
+        rows = con.execute(f"SELECT {casts} FROM ({query})").fetchall()
+        results["tasks"][str(task["task_id"])] = {
+            "expected_sql": task["expected_sql"],
+            "columns": names,
+            "types": types,
+            "rows": [list(row) for row in rows],
+        }
+    results_path.write_text(json.dumps(results, indent=2, ensure_ascii=False) + "\n", encoding="utf-8")
+
+
+def load_results(tasks: list, dataset_path: Path, results_path: Path) -> dict:
+    results = json.loads(results_path.read_text(encoding="utf-8"))
+    if results.get("dataset_sha256") != dataset_hash(dataset_path):
+        fail(f"{results_path} was computed from a different {dataset_path.name}; rerun with --refresh-results")
+    entries = results.get("tasks", {})
+    for task in tasks:
+        entry = entries.get(str(task["task_id"]))
+        if entry is None or entry["expected_sql"] != task["expected_sql"]:
+            fail(f"{results_path} is stale for task {task['task_id']}; rerun with --refresh-results")
+    return entries
+
+
+def find_perfect_hash(task_ids: list) -> tuple:
+    bits = max(1, (len(task_ids) - 1).bit_length() + 1)
+    while bits < 16:
+        for seed in range(MAX_SEED):
+            slots = {((task_id ^ seed) * HASH_MULTIPLIER & 0xFFFFFFFF) >> (32 - bits) for task_id in task_ids}
+            if len(slots) == len(task_ids):
+                return seed, bits
+        bits += 1
+    fail("no perfect hash found for the task ids")
+
+
+def c_string(value) -> str:
+    if value is None:
+        return "nullptr"
+    out = []
+    for byte in str(value).encode("utf-8"):
+        char = chr(byte)
+        if char == "\\":
+            out.append("\\\\")
+        elif char == '"':
+            out.append('\\"')
+        elif char == "\n":
+            out.append("\\n")
+        elif byte < 0x20 or byte >= 0x7F:
+            # octal escapes never swallow the following characters
+            out.append(f"\\{byte:03o}")
+        else:
+            out.append(char)
+    return '"' + "".join(out) + '"'
+
+
+def c_array(name: str, values: list) -> tuple:
+    """Returns (declaration, reference); empty arrays are not valid C++, so they are referenced as nullptr."""
+    if not values:
+        return "", "nullptr"
+    items = ",\n    ".join(c_string(v) for v in values)
+    return f"static constexpr const char *{name}[] = {{\n    {items}}};\n", name
+
+
+def generate_header(tasks: list, results: dict, ducklings: list) -> str:
+    task_ids = [task["task_id"] for task in tasks]
+    seed, bits = find_perfect_hash(task_ids)
+    slots = [-1] * (1 << bits)
+    for index, task_id in enumerate(task_ids):
+        slots[((task_id ^ seed) * HASH_MULTIPLIER & 0xFFFFFFFF) >> (32 - bits)] = index
+
+    arrays = []
+    specs = []
+    for task in tasks:
+        prefix = f"TASK_{task['task_id']}"
+        result = results[str(task["task_id"])]
+        cells = [cell for row in result["rows"] for cell in row]
+        columns_decl, columns_ref = c_array(f"{prefix}_COLUMNS", task["expected_columns"])
+        hints_decl, hints_ref = c_array(f"{prefix}_HINTS", task.get("hints", []))
+        names_decl, names_ref = c_array(f"{prefix}_RESULT_NAMES", result["columns"])
+        types_decl, types_ref = c_array(f"{prefix}_RESULT_TYPES", result["types"])
+        cells_decl, cells_ref = c_array(f"{prefix}_RESULT_CELLS", cells)
+        arrays.append(columns_decl + hints_decl + names_decl + types_decl + cells_decl)
+
+        max_rows = task.get("max_rows")
+        specs.append(
+            "    {"
+            + ", ".join(
+                [
+                    str(task["task_id"]),
+                    str(task["level"]),
+                    c_string(task["title"]),
+                    c_string(task.get("topic", "")),
+                    str(task.get("difficulty", 1)),
+                    c_string(task.get("goal", "")),
+                    c_string(task.get("badge", "")),
+                    "true" if task.get("requires_order", False) else "false",
+                    str(-1 if max_rows is None else max_rows),
+                    columns_ref,
+                    str(len(task["expected_columns"])),
+                    c_string(task["expected_sql"]),
+                    hints_ref,
+                    str(len(task.get("hints", []))),
+                    str(task.get("timeout_ms", -1)),
+                    names_ref,
+                    types_ref,
+                    str(len(result["types"])),
+                    cells_ref,
+                    str(len(result["rows"])),
+                ]
+            )
+            + "}"
+        )
+
+    duckling_list = ",\n    ".join(f"{{{c_string(name)}, {c_string(color)}, {age}}}" for name, color, age in ducklings)
+    slot_list = ", ".join(str(slot) for slot in slots)
+    asserts = "\n".join(
+        f"static_assert(FindTask({task_id}) == {index}, \"task {task_id} must hash to its own slot\");"
+        for index, task_id in enumerate(task_ids)
+    )
+    return f"""// Generated by scripts/generate_tasks.py from spec/tasks.json, spec/expected_results.json and
+// spec/ducklings.sql. Do not edit.
+
+#pragma once
+
+#include <cstdint>
+
+namespace duckdb {{
+namespace dojo_generated {{
+
+struct TaskSpec {{
+	int32_t task_id;
+	int32_t level;
+	const char *title;
+	const char *topic;
+	int32_t difficulty;
+	const char *goal;
+	const char *badge;
+	bool requires_order;
+	int32_t max_rows; // -1 means no max
+	const char *const *expected_columns;
+	uint32_t expected_column_count;
+	const char *expected_sql;
+	const char *const *hints;
+	uint32_t hint_count;
+	int64_t timeout_ms; // -1 means use the dojo_check_timeout_ms setting
+	//! Canonical result on the starter dataset: column names, type names and row-major cells cast to VARCHAR
+	//! (nullptr cells are NULL)
+	const char *const *result_names;
+	const char *const *result_types;
+	uint32_t result_column_count;
+	const char *const *result_cells;
+	uint32_t result_row_count;
+}};
+
+{"".join(arrays)}
+static constexpr TaskSpec TASKS[] = {{
+{(","+chr(10)).join(specs)}}};
+static constexpr uint32_t TASK_COUNT = {len(tasks)};
+
+//! The starter dataset, as inserted by spec/ducklings.sql
+struct StarterDuckling {{
+	const char *name;
+	const char *color;
+	int32_t age;
+}};
+
+static constexpr StarterDuckling STARTER_DUCKLINGS[] = {{
+    {duckling_list}}};
+
+static constexpr uint32_t TASK_HASH_SEED = {seed};
+static constexpr uint32_t TASK_HASH_BITS = {bits};
+static constexpr int32_t TASK_SLOTS[] = {{{slot_list}}};
+
+constexpr uint32_t TaskSlot(int32_t task_id) {{
+	return uint32_t((uint32_t(task_id) ^ TASK_HASH_SEED) * 0x{HASH_MULTIPLIER:X}u) >> (32 - TASK_HASH_BITS);
+}}
+
+//! Index of the task in TASKS, or -1
+constexpr int32_t FindTask(int32_t task_id) {{
+	return TASK_SLOTS[TaskSlot(task_id)] >= 0 && TASKS[TASK_SLOTS[TaskSlot(task_id)]].task_id == task_id
+	           ? TASK_SLOTS[TaskSlot(task_id)]
+	           : -1;
+}}
+
+{asserts}
+
+}} // namespace dojo_generated
+}} // namespace duckdb
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the dojo task registry header from spec/tasks.json")
+    parser.add_argument("--spec", type=Path, default=DEFAULT_SPEC)
+    parser.add_argument("--results", type=Path, default=DEFAULT_RESULTS)
+    parser.add_argument("--dataset", type=Path, default=DEFAULT_DATASET)
+    parser.add_argument("--output", type=Path, help="header to write")
+    parser.add_argument(
+        "--refresh-results", action="store_true", help="recompute spec/expected_results.json with duckdb"
+    )
+    args = parser.parse_args()
+
+    tasks = load_tasks(args.spec)
+    if args.refresh_results:
+        refresh_results(tasks, args.dataset, args.results)
+    if args.output is None:
+        if not args.refresh_results:
+            fail("--output is required")
+        return
+    results = load_results(tasks, args.dataset, args.results)
+    header = generate_header(tasks, results, load_ducklings(args.dataset))
+    # Leave the header untouched when nothing changed, so the extension is not rebuilt needlessly
+    if not args.output.exists() or args.output.read_text(encoding="utf-8") != header:
+        args.output.parent.mkdir(parents=True, exist_ok=True)
+        args.output.write_text(header, encoding="utf-8")
+
+
+if __name__ == "__main__":
+    main()
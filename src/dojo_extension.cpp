@@ -1,20 +1,77 @@
 #define DUCKDB_EXTENSION_MAIN
 
 #include "dojo_extension.hpp"
+#include "dojo_tasks_generated.hpp"
 
 #include "duckdb.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/common/enums/physical_operator_type.hpp"
+#include "duckdb/common/error_data.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
 #include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/types/timestamp.hpp"
 #include "duckdb/common/types/value.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
 #include "duckdb/function/scalar_function.hpp"
 #include "duckdb/function/table_function.hpp"
 #include "duckdb/main/client_context.hpp"
+#include "duckdb/main/client_context_state.hpp"
+#include "duckdb/main/config.hpp"
 #include "duckdb/main/connection.hpp"
+#include "duckdb/main/appender.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/main/database_manager.hpp"
 #include "duckdb/main/extension_util.hpp"
+#include "duckdb/main/materialized_query_result.hpp"
+#include "duckdb/main/query_profiler.hpp"
+#include "duckdb/optimizer/optimizer.hpp"
+#include "duckdb/parallel/task_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/parser/expression/function_expression.hpp"
+#include "duckdb/parser/expression/subquery_expression.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parsed_expression_iterator.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_between_expression.hpp"
+#include "duckdb/planner/expression/bound_case_expression.hpp"
+#include "duckdb/planner/expression/bound_cast_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_distinct.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_limit.hpp"
+#include "duckdb/planner/operator/logical_order.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_top_n.hpp"
+#include "duckdb/planner/planner.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include "duckdb/storage/storage_lock.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <list>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -33,695 +90,5255 @@ struct DojoTask {
 	std::vector<std::string> expected_columns;
 	std::string expected_sql; // canonical
 	std::vector<std::string> hints;
+	int64_t timeout_ms = -1; // -1 means use the dojo_check_timeout_ms setting
 };
 
+// Built-in levels, generated at build time from spec/tasks.json (see scripts/generate_tasks.py). They are copied
+// into the runtime task catalog, which looks tasks up by task_id; the generated perfect hash (dojo_generated::FindTask)
+// only serves BuiltinExpectedFingerprint().
 static const std::vector<DojoTask> &GetTasks() {
-	static const std::vector<DojoTask> tasks = {
-    {
-      1,
-      1,
-      "The Yellow Sprint",
-      "Filtering + Sorting + Limiting",
-      1,
-      R"DOJO(Find the names of ducklings that are yellow and younger than 5. Sort by age, youngest first. Show only the first 3 names.)DOJO",
-      "WHERE + AND + ORDER BY + LIMIT",
-      true,
-      3,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-WHERE color = 'yellow'
-  AND age < 5
-ORDER BY age ASC, name ASC
-LIMIT 3;)DOJO",
-      { R"DOJO(Start with SELECT name FROM ducklings)DOJO", R"DOJO(Filter with WHERE color = 'yellow')DOJO", R"DOJO(Add age condition with AND age < 5)DOJO", R"DOJO(Sort with ORDER BY age ASC)DOJO", R"DOJO(Cap results with LIMIT 3)DOJO" }
-    },
-    {
-      2,
-      2,
-      "Youngest in the Flock",
-      "Sorting + Top-1",
-      1,
-      R"DOJO(Which duck is the youngest overall? Show their name only. Sort by age, youngest first, return only one row.)DOJO",
-      "ORDER BY ASC",
-      true,
-      1,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-ORDER BY age ASC, name ASC
-LIMIT 1;)DOJO",
-      { R"DOJO(SELECT name FROM ducklings)DOJO", R"DOJO(Sort by smallest age: ORDER BY age ASC)DOJO", R"DOJO(Return one row: LIMIT 1)DOJO" }
-    },
-    {
-      3,
-      3,
-      "Elder of the Pond",
-      "Sorting + Top-1",
-      1,
-      R"DOJO(Find the oldest duck in the pond and show their name only. Sort by age, oldest first, return only one row.)DOJO",
-      "ORDER BY DESC",
-      true,
-      1,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-ORDER BY age DESC, name ASC
-LIMIT 1;)DOJO",
-      { R"DOJO(SELECT name FROM ducklings)DOJO", R"DOJO(Sort by largest age: ORDER BY age DESC)DOJO", R"DOJO(Return one row: LIMIT 1)DOJO" }
-    },
-    {
-      4,
-      4,
-      "Golden Roll Call",
-      "Filtering + Sorting by Another Column",
-      2,
-      R"DOJO(Find yellow ducklings that are age 3 or older. Sort by name A to Z. Show only the first 2 names.)DOJO",
-      "Sorting by a different column",
-      true,
-      2,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-WHERE color = 'yellow'
-  AND age >= 3
-ORDER BY name ASC
-LIMIT 2;)DOJO",
-      { R"DOJO(SELECT name FROM ducklings)DOJO", R"DOJO(WHERE color = 'yellow')DOJO", R"DOJO(Add age threshold: AND age >= 3)DOJO", R"DOJO(Sort alphabetically: ORDER BY name ASC)DOJO", R"DOJO(LIMIT 2)DOJO" }
-    },
-    {
-      5,
-      5,
-      "Fastest Waddlers",
-      "Top-N",
-      2,
-      R"DOJO(Show the names of the 4 youngest ducklings, any color. Sort by age, youngest first.)DOJO",
-      "Top-N results",
-      true,
-      4,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-ORDER BY age ASC, name ASC
-LIMIT 4;)DOJO",
-      { R"DOJO(SELECT name FROM ducklings)DOJO", R"DOJO(ORDER BY age ASC)DOJO", R"DOJO(LIMIT 4)DOJO" }
-    },
-    {
-      6,
-      6,
-      "The Between Pond",
-      "Range Filtering",
-      2,
-      R"DOJO(Find ducklings aged 2 through 4 (inclusive). Sort by age, youngest first. Show only the first 5 names.)DOJO",
-      "Range filtering (BETWEEN)",
-      true,
-      5,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-WHERE age BETWEEN 2 AND 4
-ORDER BY age ASC, name ASC
-LIMIT 5;)DOJO",
-      { R"DOJO(SELECT name FROM ducklings)DOJO", R"DOJO(Range filter: WHERE age >= 2 AND age <= 4)DOJO", R"DOJO(Alternative (also valid): WHERE age BETWEEN 2 AND 4)DOJO", R"DOJO(ORDER BY age ASC)DOJO", R"DOJO(LIMIT 5)DOJO" }
-    },
-    {
-      7,
-      7,
-      "Count the Yellow",
-      "Aggregates",
-      3,
-      R"DOJO(How many ducklings are yellow? Return a single number.)DOJO",
-      "COUNT(*)",
-      false,
-      1,
-      { "count" },
-      R"DOJO(SELECT COUNT(*) AS count
-FROM ducklings
-WHERE color = 'yellow';)DOJO",
-      { R"DOJO(Use an aggregate: SELECT COUNT(*) AS count)DOJO", R"DOJO(From the table: FROM ducklings)DOJO", R"DOJO(Filter to yellow: WHERE color = 'yellow')DOJO" }
-    },
-    {
-      8,
-      8,
-      "Color Census",
-      "GROUP BY",
-      3,
-      R"DOJO(Show how many ducklings there are of each color. Return color and count, highest count first.)DOJO",
-      "GROUP BY + Aggregates",
-      false,
-      4,
-      { "color", "count" },
-      R"DOJO(SELECT color, COUNT(*) AS count
-FROM ducklings
-GROUP BY color
-ORDER BY count DESC, color ASC;)DOJO",
-      { R"DOJO(Select the group key + aggregate: SELECT color, COUNT(*) AS count)DOJO", R"DOJO(Group rows: FROM ducklings GROUP BY color)DOJO", R"DOJO(Sort by count: ORDER BY count DESC)DOJO" }
-    },
-    {
-      9,
-      9,
-      "Popular Colors Only",
-      "HAVING",
-      4,
-      R"DOJO(Show only colors that have at least 3 ducklings. Return color and count, highest count first.)DOJO",
-      "HAVING",
-      false,
-      2,
-      { "color", "count" },
-      R"DOJO(SELECT color, COUNT(*) AS count
-FROM ducklings
-GROUP BY color
-HAVING COUNT(*) >= 3
-ORDER BY count DESC, color ASC;)DOJO",
-      { R"DOJO(Start from Level 8 (group by color with count))DOJO", R"DOJO(Filter groups using HAVING COUNT(*) >= 3)DOJO", R"DOJO(ORDER BY count DESC)DOJO" }
-    },
-    {
-      10,
-      10,
-      "The Approved Palette",
-      "IN",
-      4,
-      R"DOJO(Show duckling names where color is either yellow or brown. Sort by name A to Z.)DOJO",
-      "IN (...)",
-      true,
-      9,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-WHERE color IN ('yellow', 'brown')
-ORDER BY name ASC;)DOJO",
-      { R"DOJO(SELECT name FROM ducklings)DOJO", R"DOJO(Use IN: WHERE color IN ('yellow', 'brown'))DOJO", R"DOJO(ORDER BY name ASC)DOJO" }
-    },
-    {
-      11,
-      11,
-      "Names That Start With D",
-      "LIKE",
-      4,
-      R"DOJO(Find ducklings whose names start with the letter “D”. Sort by name A to Z.)DOJO",
-      "LIKE patterns",
-      true,
-      3,
-      { "name" },
-      R"DOJO(SELECT name
-FROM ducklings
-WHERE name LIKE 'D%'
-ORDER BY name ASC;)DOJO",
-      { R"DOJO(SELECT name FROM ducklings)DOJO", R"DOJO(Pattern match: WHERE name LIKE 'D%')DOJO", R"DOJO(ORDER BY name ASC)DOJO" }
-    },
-    {
-      12,
-      12,
-      "Age Rank Parade",
-      "Window Functions",
-      5,
-      R"DOJO(Show each duckling’s name, age, and their rank by age (youngest = 1). Sort by rank, then name.)DOJO",
-      "Window Functions (ROW_NUMBER)",
-      true,
-      12,
-      { "name", "age", "age_rank" },
-      R"DOJO(SELECT
-  name,
-  age,
-  ROW_NUMBER() OVER (ORDER BY age ASC, name ASC) AS age_rank
-FROM ducklings
-ORDER BY age_rank ASC, name ASC;)DOJO",
-      { R"DOJO(You need a window function: ROW_NUMBER() OVER (ORDER BY age ASC))DOJO", R"DOJO(Select fields: SELECT name, age, ROW_NUMBER() OVER (...) AS age_rank)DOJO", R"DOJO(Sort results: ORDER BY age_rank ASC, name ASC)DOJO" }
-    }
-	};
+	static const std::vector<DojoTask> tasks = [] {
+		std::vector<DojoTask> result;
+		for (auto &spec : dojo_generated::TASKS) {
+			DojoTask task;
+			task.task_id = spec.task_id;
+			task.level = spec.level;
+			task.title = spec.title;
+			task.topic = spec.topic;
+			task.difficulty = spec.difficulty;
+			task.goal = spec.goal;
+			task.badge = spec.badge;
+			task.requires_order = spec.requires_order;
+			task.max_rows = spec.max_rows;
+			task.expected_columns.assign(spec.expected_columns, spec.expected_columns + spec.expected_column_count);
+			task.expected_sql = spec.expected_sql;
+			task.hints.assign(spec.hints, spec.hints + spec.hint_count);
+			task.timeout_ms = spec.timeout_ms;
+			result.push_back(std::move(task));
+		}
+		return result;
+	}();
 	return tasks;
 }
 
-static const DojoTask *FindTask(int32_t task_id) {
-	auto &tasks = GetTasks();
-	for (auto &t : tasks) {
-		if (t.task_id == task_id) {
-			return &t;
+// An immutable set of tasks indexed by task_id. Loading task packs builds a new catalog and swaps it in as a whole,
+// so a statement that resolved its tasks from one catalog keeps using it until it finishes.
+class DojoTaskCatalog {
+public:
+	explicit DojoTaskCatalog(std::vector<DojoTask> tasks_p) : tasks(std::move(tasks_p)) {
+		index.reserve(tasks.size());
+		for (idx_t i = 0; i < tasks.size(); i++) {
+			if (!index.emplace(tasks[i].task_id, i).second) {
+				throw InvalidInputException("Duplicate task_id %d in task catalog", tasks[i].task_id);
+			}
 		}
 	}
-	return nullptr;
+
+	const DojoTask *Find(int32_t task_id) const {
+		auto entry = index.find(task_id);
+		return entry == index.end() ? nullptr : &tasks[entry->second];
+	}
+
+	const std::vector<DojoTask> &Tasks() const {
+		return tasks;
+	}
+
+private:
+	std::vector<DojoTask> tasks;
+	std::unordered_map<int32_t, idx_t> index;
+};
+
+static shared_ptr<const DojoTaskCatalog> BuiltinCatalog() {
+	static const auto catalog = make_shared_ptr<const DojoTaskCatalog>(GetTasks());
+	return catalog;
 }
 
+// Setup script of the starter dataset. Its rows are generated from spec/ducklings.sql, which builds the same table
+// as a TEMP table for use without the extension.
 static std::string DucklingsSetupSQL() {
-	return R"DOJO(-- duckdb_dojo v0.1 starter dataset
--- Run this in your session before attempting dojo levels:
---   .read ducklings.sql
--- or copy/paste into DuckDB.
---
--- If we implement dojo_setup() in the extension, it will execute the equivalent.
-
-CREATE OR REPLACE TEMP TABLE ducklings (
-  name  VARCHAR,
-  color VARCHAR,
-  age   INTEGER
-);
-
-INSERT INTO ducklings (name, color, age) VALUES
-  ('Daffy',   'yellow', 1),
-  ('Goldie',  'yellow', 2),
-  ('Daisy',   'yellow', 3),
-  ('Puddles', 'brown',  4),
-  ('Waddles', 'green',  5),
-  ('Beakley', 'brown',  6),
-  ('Mallow',  'green',  7),
-  ('Nugget',  'yellow', 8),
-  ('Duke',    'brown',  9),
-  ('Splash',  'blue',  10),
-  ('Moss',    'brown', 11),
-  ('Sunny',   'yellow', 12);
-
--- Sanity check:
--- SELECT * FROM ducklings ORDER BY age;)DOJO";
-}
-
-struct MaterializedRows {
+	auto &ducklings = dojo_generated::STARTER_DUCKLINGS;
+	std::ostringstream ss;
+	ss << "-- duckdb_dojo v0.2 starter dataset\n"
+	      "-- Built once per database into the in-memory catalog 'dojo_data' and shared read-only by all checks.\n"
+	      "CREATE OR REPLACE TABLE dojo_data.main.ducklings (name VARCHAR, color VARCHAR, age INTEGER);\n"
+	      "INSERT INTO dojo_data.main.ducklings (name, color, age) VALUES";
+	for (auto &duckling : ducklings) {
+		ss << (&duckling == ducklings ? "\n  " : ",\n  ") << "(" << Value(duckling.name).ToSQLString() << ", "
+		   << Value(duckling.color).ToSQLString() << ", " << duckling.age << ")";
+	}
+	ss << ";";
+	return ss.str();
+}
+
+// Content checksum of the shared dataset, used to detect a dataset that was replaced after it was built. Row hashes are
+// summed rather than XORed so that duplicated rows do not cancel out.
+static std::string DucklingsChecksumSQL() {
+	return "SELECT COALESCE(SUM(HASH(name, color, age)::HUGEINT), 0)::HUGEINT FROM dojo_data.main.ducklings";
+}
+
+// Rows generated per unit of scale factor by dojo_ducklings()
+static constexpr idx_t DUCKLINGS_ROWS_PER_SCALE = 1000000;
+static constexpr int64_t DUCKLINGS_DEFAULT_SEED = 42;
+//! Bumped whenever dojo_ducklings() produces different rows for the same parameters
+static constexpr int32_t DUCKLINGS_GENERATOR_VERSION = 1;
+
+// Which practice dataset a database uses. Scale factor 0 is the hand-written starter dataset; anything larger is
+// generated deterministically from the seed by dojo_ducklings().
+struct DatasetSpec {
+	double scale_factor = 0;
+	int64_t seed = DUCKLINGS_DEFAULT_SEED;
+
+	bool IsDefault() const {
+		return scale_factor <= 0;
+	}
+
+	idx_t GeneratedRows() const {
+		return idx_t(scale_factor * double(DUCKLINGS_ROWS_PER_SCALE) + 0.5);
+	}
+
+	std::string BuildSQL() const {
+		if (IsDefault()) {
+			return DucklingsSetupSQL();
+		}
+		return StringUtil::Format("CREATE OR REPLACE TABLE dojo_data.main.ducklings AS SELECT name, color, age FROM "
+		                          "dojo_ducklings(scale_factor := %s, seed := %lld)",
+		                          Value::DOUBLE(scale_factor).ToSQLString(), (long long)seed);
+	}
+
+	// Identifies the contents of the dataset. Anything derived from it (e.g. canonical results) is keyed by this, so
+	// changing the setup script, the generator or its parameters invalidates it automatically.
+	std::string Version() const {
+		auto sql = BuildSQL();
+		std::ostringstream ss;
+		ss << std::hex << Hash(sql.c_str(), sql.size());
+		if (!IsDefault()) {
+			ss << "-gen" << DUCKLINGS_GENERATOR_VERSION;
+		}
+		return ss.str();
+	}
+};
+
+// Order-insensitive digest of a multiset of rows. Per-row hashes are combined with two commutative accumulators, so
+// equal multisets always produce equal digests regardless of row order, in constant memory. Both accumulators are fed
+// from the same 64-bit row hash: the second one makes it unlikely that the hashes of different rows cancel out in the
+// sum, but two rows whose 64-bit hashes collide are indistinguishable.
+struct MultisetDigest {
+	uint64_t sum = 0;
+	uint64_t mixed_sum = 0;
+
+	bool operator==(const MultisetDigest &other) const {
+		return sum == other.sum && mixed_sum == other.mixed_sum;
+	}
+	bool operator!=(const MultisetDigest &other) const {
+		return !(*this == other);
+	}
+};
+
+// Cost of one query run, as reported by the inner connection's query profiler.
+struct QueryMetrics {
+	bool valid = false;
+	double elapsed_ms = 0;
+	idx_t rows_scanned = 0;
+	idx_t peak_memory = 0;
+	idx_t bytes_read = 0;
+};
+
+// Order-sensitive digest of a sequence of rows: per-row hashes are folded in one after the other. The state is 128
+// bits, but it is fed 64-bit row hashes, so two rows whose hashes collide are indistinguishable.
+struct SequenceDigest {
+	uint64_t low = 0;
+	uint64_t high = 0;
+
+	void Add(hash_t hash) {
+		low = MurmurHash64(low ^ hash);
+		high = (high ^ MurmurHash64(hash ^ 0xC2B2AE3D27D4EB4FULL)) * 0x100000001B3ULL;
+	}
+
+	bool operator==(const SequenceDigest &other) const {
+		return low == other.low && high == other.high;
+	}
+	bool operator!=(const SequenceDigest &other) const {
+		return !(*this == other);
+	}
+};
+
+// An ordered check compares the running sequence digest every this many rows, so it can stop at the first differing
+// block instead of reading the whole result
+static constexpr idx_t FINGERPRINT_CHECKPOINT_ROWS = STANDARD_VECTOR_SIZE;
+
+// Compact stand-in for a query result: its shape, row count and digests, built while the result streams by. Expected
+// results are kept as fingerprints, so checking a correct answer takes no memory proportional to the result size.
+struct ResultFingerprint {
 	std::vector<std::string> col_names;
-	std::vector<std::vector<std::string>> rows; // rows[col] stringified
+	vector<LogicalType> types;      // as produced by the query
+	vector<LogicalType> hash_types; // the rows were hashed as these, see HashRows()
+	idx_t row_count = 0;
+	MultisetDigest multiset; // for unordered levels
+	SequenceDigest sequence; // for ordered levels
+	//! sequence after every FINGERPRINT_CHECKPOINT_ROWS rows
+	std::vector<SequenceDigest> checkpoints;
+	QueryMetrics metrics; // of the canonical run that produced the fingerprint
+
+	//! Adds the rows of chunk, or only its first limit rows
+	void Sink(DataChunk &chunk, idx_t limit = DConstants::INVALID_INDEX);
 };
 
-static MaterializedRows Materialize(QueryResult &result) {
-	MaterializedRows out;
-	out.col_names = result.names;
+// -------------------------- per-database state --------------------------
 
-	while (true) {
-		auto chunk = result.Fetch();
-		if (!chunk || chunk->size() == 0) {
-			break;
+// Canonical results only depend on the task and the dataset, so they are computed once and shared by every check
+// running against the same database.
+class ExpectedResultCache {
+public:
+	shared_ptr<const ResultFingerprint> Get(const std::string &key) {
+		lock_guard<mutex> guard(lock);
+		auto entry = entries.find(key);
+		if (entry == entries.end()) {
+			misses++;
+			return nullptr;
+		}
+		hits++;
+		return entry->second;
+	}
+
+	// Returns the cached entry if another check filled it first, so concurrent misses converge on one result. A
+	// profiled run replaces a build-time result, which carries no metrics.
+	shared_ptr<const ResultFingerprint> Put(const std::string &key, shared_ptr<const ResultFingerprint> rows) {
+		lock_guard<mutex> guard(lock);
+		auto entry = entries.emplace(key, rows);
+		if (!entry.second && !entry.first->second->metrics.valid && rows->metrics.valid) {
+			entry.first->second = std::move(rows);
+		}
+		return entry.first->second;
+	}
+
+	idx_t EntryCount() {
+		lock_guard<mutex> guard(lock);
+		return entries.size();
+	}
+
+	// Reloaded task packs may change a task's expected_sql without changing its id
+	static std::string Key(const DojoTask &task, const std::string &dataset_version) {
+		std::ostringstream ss;
+		ss << task.task_id << ":" << std::hex << Hash(task.expected_sql.c_str(), task.expected_sql.size()) << "@"
+		   << dataset_version;
+		return ss.str();
+	}
+
+	std::atomic<idx_t> hits {0};
+	std::atomic<idx_t> misses {0};
+
+private:
+	mutex lock;
+	std::unordered_map<std::string, shared_ptr<const ResultFingerprint>> entries;
+};
+
+// Canonical plans of the tasks' canonical queries, keyed like the expected results. An empty plan means the canonical
+// query has no canonical form, so submissions for that task always run.
+class CanonicalPlanCache {
+public:
+	bool Get(const std::string &key, std::string &plan) {
+		lock_guard<mutex> guard(lock);
+		auto entry = entries.find(key);
+		if (entry == entries.end()) {
+			return false;
+		}
+		plan = entry->second;
+		return true;
+	}
+
+	void Put(const std::string &key, const std::string &plan) {
+		lock_guard<mutex> guard(lock);
+		entries[key] = plan;
+	}
+
+private:
+	mutex lock;
+	std::unordered_map<std::string, std::string> entries;
+};
+
+enum class CheckAbortReason : uint8_t { NONE, TIMEOUT, MEMORY, CANCELLED };
+
+// Interrupts inner check connections that run past their deadline, or whose outer statement was cancelled. A single
+// thread per database serves all running checks; it is started by the first guarded check. MEMORY is not a watchdog
+// reason: DuckDB only accounts memory per database, so a check whose query fails for want of memory is reported as
+// such by RunCheck().
+class CheckWatchdog {
+public:
+	struct Watch {
+		ClientContext *inner;
+		//! The interrupted flag of the outer statement's client context
+		optional_ptr<const std::atomic<bool>> cancelled;
+		std::chrono::steady_clock::time_point deadline;
+		bool has_deadline;
+		std::atomic<CheckAbortReason> reason {CheckAbortReason::NONE};
+	};
+
+	~CheckWatchdog() {
+		{
+			lock_guard<mutex> guard(lock);
+			stop = true;
+		}
+		cv.notify_all();
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+
+	void Register(Watch &watch) {
+		lock_guard<mutex> guard(lock);
+		watches.push_back(&watch);
+		if (!thread.joinable()) {
+			thread = std::thread([this]() { Run(); });
+		}
+		cv.notify_all();
+	}
+
+	//! After this returns the watchdog no longer touches the watched connection.
+	void Unregister(Watch &watch) {
+		lock_guard<mutex> guard(lock);
+		watches.erase(std::remove(watches.begin(), watches.end(), &watch), watches.end());
+	}
+
+private:
+	void Run() {
+		// Cancellation of the outer statement has no deadline to wait for, so it is polled
+		static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(10);
+		unique_lock<mutex> guard(lock);
+		while (!stop) {
+			if (watches.empty()) {
+				cv.wait(guard);
+				continue;
+			}
+			auto now = std::chrono::steady_clock::now();
+			for (auto watch : watches) {
+				if (watch->reason.load() != CheckAbortReason::NONE) {
+					continue;
+				}
+				auto reason = CheckAbortReason::NONE;
+				if (watch->cancelled && watch->cancelled->load()) {
+					reason = CheckAbortReason::CANCELLED;
+				} else if (watch->has_deadline && now >= watch->deadline) {
+					reason = CheckAbortReason::TIMEOUT;
+				}
+				if (reason != CheckAbortReason::NONE) {
+					watch->reason = reason;
+					watch->inner->Interrupt();
+				}
+			}
+			cv.wait_for(guard, POLL_INTERVAL);
+		}
+	}
+
+	mutex lock;
+	std::condition_variable cv;
+	std::thread thread;
+	bool stop = false;
+	vector<Watch *> watches;
+};
+
+// Phases of a check. The user's result is fingerprinted while it is fetched, so USER_QUERY includes hashing it; COMPARE
+// is the final verdict and, for ordered levels, locating the first differing row.
+enum class CheckPhase : uint8_t { SETUP, CANONICAL, USER_QUERY, COMPARE, TOTAL };
+static constexpr idx_t CHECK_PHASE_COUNT = 5;
+static const char *const CHECK_PHASE_NAMES[] = {"setup", "canonical", "user_query", "compare", "total"};
+
+enum class CheckCounter : uint8_t {
+	CHECKS,
+	PASSES,
+	USER_ERRORS,
+	INTERNAL_ERRORS,
+	TIMEOUTS,
+	MEMORY_ABORTS,
+	CANCELLATIONS,
+	CACHE_HITS,
+	CACHE_MISSES,
+	VERDICT_CACHE_HITS,
+	COALESCED,
+	PLAN_MATCHES,
+	VARIANT_RUNS
+};
+static constexpr idx_t CHECK_COUNTER_COUNT = 13;
+static const char *const CHECK_COUNTER_NAMES[] = {
+    "checks",        "passes",     "user_errors",  "internal_errors",    "timeouts",  "memory_aborts",
+    "cancellations", "cache_hits", "cache_misses", "verdict_cache_hits", "coalesced", "plan_matches",
+    "variant_runs"};
+
+// Latencies are bucketed on a log scale with 4 buckets per power of two microseconds, so a percentile read from a
+// histogram is at most 19% above the exact one. The last bucket also takes everything above 2^36 us (about 19 hours).
+static constexpr idx_t HISTOGRAM_SUB_BUCKETS = 4;
+static constexpr idx_t HISTOGRAM_BUCKETS = 36 * HISTOGRAM_SUB_BUCKETS;
+
+static idx_t HistogramBucket(uint64_t micros) {
+	if (micros <= 1) {
+		return 0;
+	}
+	auto bucket = idx_t(std::log2(double(micros)) * HISTOGRAM_SUB_BUCKETS);
+	return MinValue<idx_t>(bucket, HISTOGRAM_BUCKETS - 1);
+}
+
+//! Upper bound of a bucket in milliseconds
+static double HistogramBucketMs(idx_t bucket) {
+	return std::pow(2.0, double(bucket + 1) / HISTOGRAM_SUB_BUCKETS) / 1000.0;
+}
+
+// Phase timings and outcome counters of one check, collected locally while it runs.
+struct CheckSample {
+	uint64_t micros[CHECK_PHASE_COUNT] = {};
+	bool reached[CHECK_PHASE_COUNT] = {};
+	uint64_t counters[CHECK_COUNTER_COUNT] = {};
+};
+
+// Histogram bucket counts and counters summed over shards or tasks, for reading.
+struct CheckStatsSnapshot {
+	CheckStatsSnapshot() : phases(CHECK_PHASE_COUNT, vector<uint64_t>(HISTOGRAM_BUCKETS, 0)) {
+	}
+
+	vector<vector<uint64_t>> phases;
+	uint64_t counters[CHECK_COUNTER_COUNT] = {};
+};
+
+// Latency histograms per phase and outcome counters of a set of checks. Updated with relaxed atomic increments.
+struct CheckStatsBlock {
+	CheckStatsBlock() {
+		Reset();
+	}
+
+	void Add(const CheckSample &sample) {
+		for (idx_t phase = 0; phase < CHECK_PHASE_COUNT; phase++) {
+			if (sample.reached[phase]) {
+				phases[phase][HistogramBucket(sample.micros[phase])].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		for (idx_t counter = 0; counter < CHECK_COUNTER_COUNT; counter++) {
+			if (sample.counters[counter] > 0) {
+				counters[counter].fetch_add(sample.counters[counter], std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void AddTo(CheckStatsSnapshot &snapshot) const {
+		for (idx_t phase = 0; phase < CHECK_PHASE_COUNT; phase++) {
+			for (idx_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+				snapshot.phases[phase][bucket] += phases[phase][bucket].load(std::memory_order_relaxed);
+			}
+		}
+		for (idx_t counter = 0; counter < CHECK_COUNTER_COUNT; counter++) {
+			snapshot.counters[counter] += counters[counter].load(std::memory_order_relaxed);
+		}
+	}
+
+	void Reset() {
+		for (auto &histogram : phases) {
+			for (auto &bucket : histogram) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+		for (auto &counter : counters) {
+			counter.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	std::atomic<uint64_t> phases[CHECK_PHASE_COUNT][HISTOGRAM_BUCKETS];
+	std::atomic<uint64_t> counters[CHECK_COUNTER_COUNT];
+};
+
+struct TaskStatsBlock {
+	explicit TaskStatsBlock(int32_t task_id_p) : task_id(task_id_p) {
+	}
+
+	const int32_t task_id;
+	CheckStatsBlock stats;
+};
+
+// Statistics of all checks of the database, in total and per task. Recording takes no locks: the totals are spread
+// over shards picked by thread, so concurrent checks rarely increment the same counters, and per-task blocks live in
+// an open-addressed table whose slots are claimed with a compare-and-swap and never freed before the database closes.
+class CheckStats {
+public:
+	static constexpr idx_t SHARD_COUNT = 16;
+	//! Checks of tasks beyond this many distinct task ids only count towards the totals
+	static constexpr idx_t TASK_SLOTS = 1024;
+
+	CheckStats() {
+		for (auto &slot : task_slots) {
+			slot.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	~CheckStats() {
+		for (auto &slot : task_slots) {
+			delete slot.load(std::memory_order_relaxed);
+		}
+	}
+
+	void Record(int32_t task_id, const CheckSample &sample) {
+		static thread_local const idx_t shard = std::hash<std::thread::id>()(std::this_thread::get_id()) % SHARD_COUNT;
+		shards[shard].Add(sample);
+		auto task = FindTask(task_id);
+		if (task) {
+			task->stats.Add(sample);
+		}
+	}
+
+	CheckStatsSnapshot Totals() const {
+		CheckStatsSnapshot snapshot;
+		for (auto &shard : shards) {
+			shard.AddTo(snapshot);
+		}
+		return snapshot;
+	}
+
+	//! Snapshots of every task with statistics, by task_id
+	std::vector<std::pair<int32_t, CheckStatsSnapshot>> Tasks() const {
+		std::vector<std::pair<int32_t, CheckStatsSnapshot>> result;
+		for (auto &slot : task_slots) {
+			auto task = slot.load(std::memory_order_acquire);
+			if (task) {
+				result.emplace_back(task->task_id, CheckStatsSnapshot());
+				task->stats.AddTo(result.back().second);
+			}
+		}
+		std::sort(result.begin(), result.end(),
+		          [](const std::pair<int32_t, CheckStatsSnapshot> &left,
+		             const std::pair<int32_t, CheckStatsSnapshot> &right) { return left.first < right.first; });
+		return result;
+	}
+
+	//! Checks that are running meanwhile may still be recorded partially
+	void Reset() {
+		for (auto &shard : shards) {
+			shard.Reset();
+		}
+		for (auto &slot : task_slots) {
+			auto task = slot.load(std::memory_order_acquire);
+			if (task) {
+				task->stats.Reset();
+			}
+		}
+	}
+
+private:
+	//! The task's block, claiming a free slot for it if needed; nullptr if the table is full
+	TaskStatsBlock *FindTask(int32_t task_id) {
+		auto start = idx_t(MurmurHash64(uint64_t(uint32_t(task_id))) % TASK_SLOTS);
+		for (idx_t i = 0; i < TASK_SLOTS; i++) {
+			auto &slot = task_slots[(start + i) % TASK_SLOTS];
+			auto task = slot.load(std::memory_order_acquire);
+			if (!task) {
+				auto fresh = make_uniq<TaskStatsBlock>(task_id);
+				if (slot.compare_exchange_strong(task, fresh.get(), std::memory_order_acq_rel)) {
+					return fresh.release();
+				}
+				// another thread claimed the slot first; task now points to its block
+			}
+			if (task->task_id == task_id) {
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	CheckStatsBlock shards[SHARD_COUNT];
+	std::atomic<TaskStatsBlock *> task_slots[TASK_SLOTS];
+};
+
+// One graded submission, as appended to the attempt log.
+struct DojoAttempt {
+	timestamp_t attempted_at;
+	std::string user_name;
+	int32_t task_id = 0;
+	bool ok = false;
+	double latency_ms = 0;
+	//! Digest of the user's result; empty unless the result was read to completion
+	std::string fingerprint;
+};
+
+// One user's attempts at one task.
+struct DojoTaskProgress {
+	idx_t attempts = 0;
+	idx_t passes = 0;
+	//! Of the fastest passing attempt
+	double best_latency_ms = 0;
+	timestamp_t first_solved_at;
+};
+
+// One user's standing over all tasks.
+struct DojoStanding {
+	idx_t attempts = 0;
+	idx_t solved = 0;
+	//! Sum of the fastest passing latency of each solved task
+	double solved_latency_ms = 0;
+	timestamp_t last_solved_at;
+};
+
+using DojoUserProgress = std::unordered_map<int32_t, DojoTaskProgress>;
+
+//! The writer appends a batch once this many attempts are queued, or when the oldest one waited this long
+static constexpr idx_t ATTEMPT_LOG_BATCH_SIZE = 256;
+static constexpr auto ATTEMPT_LOG_FLUSH_INTERVAL = std::chrono::milliseconds(200);
+
+// Attempts waiting to be appended to the log table, shared with the thread that writes them. The writer references
+// the database only while it writes a batch. If that turns out to be the last reference, the database and its
+// DojoState are destroyed on the writer thread, so the queue must be able to outlive them.
+struct AttemptQueue {
+	explicit AttemptQueue(DatabaseInstance &db_p) : db(db_p.shared_from_this()) {
+	}
+
+	void Run();
+	void Write(const std::string &target, const vector<DojoAttempt> &batch, std::string &err);
+
+	weak_ptr<DatabaseInstance> db;
+	mutex lock;
+	//! Wakes the writer
+	std::condition_variable wake;
+	//! Signals Flush() that a batch was handled
+	std::condition_variable handled_cv;
+	bool stop = false;
+	//! Qualified name of the log table; empty until the database starts logging
+	std::string table;
+	vector<DojoAttempt> pending;
+	idx_t queued = 0;
+	//! Attempts taken off the queue, whether or not they could be written
+	idx_t handled = 0;
+	idx_t appended = 0;
+	idx_t flush_waiters = 0;
+	//! Error of the last batch that failed to write, reported by the next Flush()
+	std::string error;
+};
+
+// Attempt log of the database, enabled by SET dojo_attempt_log. A check only queues its attempt; a writer thread
+// appends the queue to the log table in batches, so checks never wait on the table. Progress and standings are
+// updated as attempts are queued, so dojo_progress() and dojo_leaderboard() never scan the log: its rows are read
+// once, when the database starts logging to the table.
+class AttemptLog {
+public:
+	explicit AttemptLog(DatabaseInstance &db) : queue(make_shared_ptr<AttemptQueue>(db)) {
+	}
+
+	~AttemptLog() {
+		{
+			lock_guard<mutex> guard(queue->lock);
+			queue->stop = true;
+		}
+		queue->wake.notify_all();
+		if (!thread.joinable()) {
+			return;
+		}
+		if (thread.get_id() == std::this_thread::get_id()) {
+			// The writer released the last reference to the database; it finishes on its own
+			thread.detach();
+		} else {
+			thread.join();
+		}
+	}
+
+	//! Qualified name of the table attempts are logged to; empty until Attach()
+	std::string Table() {
+		lock_guard<mutex> guard(queue->lock);
+		return queue->table;
+	}
+
+	//! Creates the log table if needed and starts logging to it, reading progress and standings from its rows.
+	void Attach(Connection &con, const std::string &table);
+
+	void Record(DojoAttempt attempt) {
+		lock_guard<mutex> guard(lock);
+		Apply(progress, standings, attempt);
+		lock_guard<mutex> queue_guard(queue->lock);
+		queue->pending.push_back(std::move(attempt));
+		queue->queued++;
+		if (!thread.joinable()) {
+			auto shared = queue;
+			thread = std::thread([shared]() { shared->Run(); });
+		}
+		if (queue->pending.size() >= ATTEMPT_LOG_BATCH_SIZE) {
+			queue->wake.notify_all();
+		}
+	}
+
+	//! Waits until every attempt queued so far has been written, and returns the number of attempts in the log
+	//! table that were written by this database.
+	idx_t Flush() {
+		unique_lock<mutex> guard(queue->lock);
+		auto target = queue->queued;
+		queue->flush_waiters++;
+		queue->wake.notify_all();
+		queue->handled_cv.wait(guard, [&]() { return queue->handled >= target; });
+		queue->flush_waiters--;
+		if (!queue->error.empty()) {
+			auto err = std::move(queue->error);
+			queue->error.clear();
+			throw IOException("Failed to write the attempt log: %s", err);
+		}
+		return queue->appended;
+	}
+
+	DojoUserProgress Progress(const std::string &user_name) {
+		lock_guard<mutex> guard(lock);
+		auto entry = progress.find(user_name);
+		return entry == progress.end() ? DojoUserProgress() : entry->second;
+	}
+
+	std::vector<std::pair<std::string, DojoStanding>> Standings() {
+		lock_guard<mutex> guard(lock);
+		return std::vector<std::pair<std::string, DojoStanding>>(standings.begin(), standings.end());
+	}
+
+private:
+	static void Apply(std::unordered_map<std::string, DojoUserProgress> &progress,
+	                  std::unordered_map<std::string, DojoStanding> &standings, const DojoAttempt &attempt) {
+		auto &task = progress[attempt.user_name][attempt.task_id];
+		auto &standing = standings[attempt.user_name];
+		task.attempts++;
+		standing.attempts++;
+		if (!attempt.ok) {
+			return;
+		}
+		if (task.passes == 0) {
+			task.best_latency_ms = attempt.latency_ms;
+			task.first_solved_at = attempt.attempted_at;
+			standing.solved++;
+			standing.solved_latency_ms += attempt.latency_ms;
+			standing.last_solved_at = attempt.attempted_at;
+		} else if (attempt.latency_ms < task.best_latency_ms) {
+			standing.solved_latency_ms += attempt.latency_ms - task.best_latency_ms;
+			task.best_latency_ms = attempt.latency_ms;
+		}
+		task.passes++;
+	}
+
+	//! Guards progress and standings; taken before queue->lock
+	mutex lock;
+	std::unordered_map<std::string, DojoUserProgress> progress;
+	std::unordered_map<std::string, DojoStanding> standings;
+	//! Serializes switching to another log table
+	mutex attach_lock;
+	shared_ptr<AttemptQueue> queue;
+	//! The writer; started by the first recorded attempt (under queue->lock)
+	std::thread thread;
+};
+
+struct DojoVerdict {
+	bool ok = false;
+	std::string message;
+	idx_t expected_rows = 0;
+	idx_t actual_rows = 0;
+	//! See ResultChecker::ActualFingerprint(); empty unless the user's result was read to completion
+	std::string fingerprint;
+	//! Whether the verdict only depends on the submission, the task and the dataset. Aborted checks and internal
+	//! errors depend on the run and are not reused.
+	bool reusable = false;
+	QueryMetrics user_metrics;
+	QueryMetrics expected_metrics;
+};
+
+// The verdict of one check of a submission, which identical checks can wait for.
+struct VerdictFlight {
+	//! Waits until the verdict is in. Returns false if the outer statement is cancelled (sets cancelled) first.
+	bool Wait(const std::atomic<bool> &cancelled, bool &waited) {
+		unique_lock<mutex> guard(lock);
+		waited = !done;
+		while (!done) {
+			if (cancelled.load()) {
+				return false;
+			}
+			cv.wait_for(guard, std::chrono::milliseconds(10));
+		}
+		return true;
+	}
+
+	mutex lock;
+	std::condition_variable cv;
+	bool done = false;
+	DojoVerdict verdict;
+};
+
+// Verdicts of recent submissions, by task, dataset, check budget and normalized SQL. A check whose key is present
+// reuses that verdict; if the verdict is still being computed, the check waits for it instead of running the same
+// queries again. Least recently used entries are evicted beyond the capacity.
+class VerdictCache {
+public:
+	//! Returns the flight of the key. Sets leader if there was none: the caller then runs the check and passes its
+	//! verdict to Finish().
+	shared_ptr<VerdictFlight> Join(const std::string &key, idx_t capacity, bool &leader) {
+		lock_guard<mutex> guard(lock);
+		auto entry = entries.find(key);
+		if (entry != entries.end()) {
+			lru.splice(lru.begin(), lru, entry->second.position);
+			leader = false;
+			return entry->second.flight;
+		}
+		leader = true;
+		auto flight = make_shared_ptr<VerdictFlight>();
+		lru.push_front(key);
+		entries.emplace(key, Entry {flight, lru.begin()});
+		while (entries.size() > capacity) {
+			// A flight that is evicted while running still completes for the checks that joined it
+			entries.erase(lru.back());
+			lru.pop_back();
+		}
+		return flight;
+	}
+
+	void Finish(const std::string &key, const shared_ptr<VerdictFlight> &flight, const DojoVerdict &verdict) {
+		{
+			lock_guard<mutex> guard(flight->lock);
+			flight->verdict = verdict;
+			flight->done = true;
+		}
+		flight->cv.notify_all();
+		if (verdict.reusable) {
+			return;
+		}
+		lock_guard<mutex> guard(lock);
+		auto entry = entries.find(key);
+		if (entry != entries.end() && entry->second.flight == flight) {
+			lru.erase(entry->second.position);
+			entries.erase(entry);
+		}
+	}
+
+private:
+	struct Entry {
+		shared_ptr<VerdictFlight> flight;
+		std::list<std::string>::iterator position;
+	};
+
+	mutex lock;
+	//! Keys, most recently used first
+	std::list<std::string> lru;
+	std::unordered_map<std::string, Entry> entries;
+};
+
+//! Graded results of dojo_submit() are kept for this many of the most recently graded submissions
+static constexpr idx_t GRADING_RESULT_RETENTION = 65536;
+
+enum class GradingStatus : uint8_t { QUEUED, RUNNING, DONE };
+static const char *const GRADING_STATUS_NAMES[] = {"queued", "running", "done"};
+
+// A submission queued by dojo_submit(), with everything needed to grade it away from the submitting connection.
+struct GradingJob {
+	idx_t ticket = 0;
+	//! Keeps the task alive even if the catalog is reloaded while the submission waits
+	shared_ptr<const DojoTaskCatalog> catalog;
+	const DojoTask *task = nullptr;
+	std::string user_sql;
+	idx_t variants = 0;
+	std::string attempt_user;
+	//! Check settings of the submitting connection, applied to the connection that grades it
+	vector<std::pair<std::string, Value>> settings;
+};
+
+// The state of one ticket, as dojo_result() and dojo_results() report it.
+struct GradingTicket {
+	int32_t task_id = 0;
+	GradingStatus status = GradingStatus::QUEUED;
+	timestamp_t submitted_at;
+	timestamp_t finished_at;
+	//! Position of the ticket in the order submissions finished grading, starting at 1; 0 until it is done
+	idx_t sequence = 0;
+	DojoVerdict verdict;
+};
+
+// Submissions waiting to be graded and the tickets of recent ones, shared with the worker threads. Like the attempt
+// log writer, a worker references the database only while it grades a submission, so the queue must be able to outlive
+// the database and its DojoState.
+struct GradingQueue {
+	explicit GradingQueue(DatabaseInstance &db_p) : db(db_p.shared_from_this()) {
+	}
+
+	void Run();
+	DojoVerdict Grade(const GradingJob &job);
+
+	weak_ptr<DatabaseInstance> db;
+	mutex lock;
+	//! Wakes the workers
+	std::condition_variable wake;
+	//! Signals dojo_result(wait := true) that a submission was graded
+	std::condition_variable graded_cv;
+	bool stop = false;
+	std::deque<GradingJob> pending;
+	std::unordered_map<idx_t, GradingTicket> tickets;
+	//! Tickets that are done, in the order they finished, so the oldest results are forgotten first
+	std::deque<idx_t> finished;
+	idx_t next_ticket = 1;
+	idx_t next_sequence = 1;
+};
+
+// Background grading for dojo_submit(). A submission only takes a ticket and joins a bounded queue; worker threads of
+// the database grade the queue, each submission on a connection of its own. Workers are started on demand, up to the
+// largest dojo_grading_workers setting a submission was made with.
+class GradingPool {
+public:
+	explicit GradingPool(DatabaseInstance &db) : queue(make_shared_ptr<GradingQueue>(db)) {
+	}
+
+	~GradingPool() {
+		{
+			lock_guard<mutex> guard(queue->lock);
+			queue->stop = true;
+		}
+		queue->wake.notify_all();
+		queue->graded_cv.notify_all();
+		for (auto &thread : threads) {
+			if (thread.get_id() == std::this_thread::get_id()) {
+				// This worker released the last reference to the database; it finishes on its own
+				thread.detach();
+			} else {
+				thread.join();
+			}
+		}
+	}
+
+	//! Queues the job and returns its ticket. Throws if max_queued submissions are already waiting.
+	idx_t Submit(GradingJob job, idx_t max_queued, idx_t workers) {
+		idx_t ticket;
+		{
+			lock_guard<mutex> guard(queue->lock);
+			if (queue->pending.size() >= max_queued) {
+				throw InvalidInputException(
+				    "dojo_submit: the grading queue is full (%llu submissions waiting). Retry later, or raise "
+				    "dojo_grading_queue_size.",
+				    (unsigned long long)queue->pending.size());
+			}
+			ticket = queue->next_ticket++;
+			job.ticket = ticket;
+			auto &entry = queue->tickets[ticket];
+			entry.task_id = job.task->task_id;
+			entry.submitted_at = Timestamp::GetCurrentTimestamp();
+			queue->pending.push_back(std::move(job));
+		}
+		queue->wake.notify_one();
+		lock_guard<mutex> guard(threads_lock);
+		while (threads.size() < workers) {
+			auto shared = queue;
+			threads.emplace_back([shared]() { shared->Run(); });
+		}
+		return ticket;
+	}
+
+	//! Looks up a ticket, with wait set until it is done. Returns false if the ticket is unknown or its result was
+	//! already forgotten. Throws if the statement is cancelled while it waits.
+	bool Find(ClientContext &context, idx_t ticket, bool wait, GradingTicket &result) {
+		unique_lock<mutex> guard(queue->lock);
+		while (true) {
+			auto entry = queue->tickets.find(ticket);
+			if (entry == queue->tickets.end()) {
+				return false;
+			}
+			if (!wait || entry->second.status == GradingStatus::DONE) {
+				result = entry->second;
+				return true;
+			}
+			if (context.interrupted || queue->stop) {
+				throw InterruptException();
+			}
+			queue->graded_cv.wait_for(guard, std::chrono::milliseconds(10));
+		}
+	}
+
+	//! All known tickets in ticket order, or with after set only those that finished after the given sequence
+	//! number, in the order they finished.
+	vector<std::pair<idx_t, GradingTicket>> Tickets(optional_idx after) {
+		vector<std::pair<idx_t, GradingTicket>> result;
+		lock_guard<mutex> guard(queue->lock);
+		if (after.IsValid()) {
+			for (auto ticket : queue->finished) {
+				auto &entry = queue->tickets[ticket];
+				if (entry.sequence > after.GetIndex()) {
+					result.emplace_back(ticket, entry);
+				}
+			}
+			return result;
+		}
+		for (auto &entry : queue->tickets) {
+			result.emplace_back(entry.first, entry.second);
+		}
+		std::sort(result.begin(), result.end(),
+		          [](const std::pair<idx_t, GradingTicket> &a, const std::pair<idx_t, GradingTicket> &b) {
+			          return a.first < b.first;
+		          });
+		return result;
+	}
+
+private:
+	shared_ptr<GradingQueue> queue;
+	mutex threads_lock;
+	std::vector<std::thread> threads;
+};
+
+class SandboxPool;
+
+//! A check's shared hold on the dataset catalogs of a database (see DojoState::dataset_use)
+using DatasetLease = unique_ptr<StorageLockKey>;
+
+// Lives in the database's object cache: one instance per DatabaseInstance, shared by all of its connections.
+class DojoState : public ObjectCacheEntry {
+public:
+	static std::string ObjectType() {
+		return "dojo_state";
+	}
+
+	std::string GetObjectType() override {
+		return ObjectType();
+	}
+
+	// Never evicted: the state holds counters that must survive for the lifetime of the database.
+	optional_idx GetEstimatedCacheMemory() const {
+		return optional_idx();
+	}
+
+	explicit DojoState(DatabaseInstance &db) : attempt_log(db), grading(db), catalog(BuiltinCatalog()) {
+	}
+
+	static shared_ptr<DojoState> Get(ClientContext &context) {
+		return ObjectCache::GetObjectCache(context).GetOrCreate<DojoState>(ObjectType(), *context.db);
+	}
+
+	//! Snapshot of the current task catalog
+	shared_ptr<const DojoTaskCatalog> Catalog() {
+		lock_guard<mutex> guard(catalog_lock);
+		return catalog;
+	}
+
+	//! Swaps in replacement if the catalog is still current; returns false if another load swapped it meanwhile
+	bool ReplaceCatalog(const shared_ptr<const DojoTaskCatalog> &current,
+	                    shared_ptr<const DojoTaskCatalog> replacement) {
+		lock_guard<mutex> guard(catalog_lock);
+		if (catalog != current) {
+			return false;
+		}
+		catalog = std::move(replacement);
+		return true;
+	}
+
+	ExpectedResultCache expected_cache;
+	CanonicalPlanCache plan_cache;
+	VerdictCache verdict_cache;
+
+	//! Held shared by checks for as long as they read a dataset catalog and exclusively while one is rebuilt, so a
+	//! rebuild never detaches a catalog under a running check or swaps its rows for another version's. Taken before
+	//! dataset_lock.
+	StorageLock dataset_use;
+	//! Guards building the shared dataset; the version is empty until it has been built in this database
+	mutex dataset_lock;
+	DatasetSpec dataset_spec;
+	std::string dataset_version;
+	hugeint_t dataset_checksum = 0;
+	//! Version of each dataset variant built in this database, by variant index (also guarded by dataset_lock)
+	std::unordered_map<idx_t, std::string> variant_versions;
+
+	CheckWatchdog watchdog;
+	AttemptLog attempt_log;
+	GradingPool grading;
+	CheckStats stats;
+
+	//! Sets of sandbox databases that checks run in, one per combination of dojo_sandbox_* settings, most recently
+	//! used first; empty until the first check with dojo_sandbox_instances set
+	mutex sandbox_lock;
+	std::list<shared_ptr<SandboxPool>> sandboxes;
+
+private:
+	mutex catalog_lock;
+	shared_ptr<const DojoTaskCatalog> catalog;
+};
+
+// -------------------------- typed result comparison --------------------------
+
+// A position inside a chunk, with its columns in unified format.
+struct ChunkCursor {
+	void Load(DataChunk &chunk_p) {
+		chunk = &chunk_p;
+		offset = 0;
+		formats.resize(chunk->ColumnCount());
+		for (idx_t c = 0; c < chunk->ColumnCount(); c++) {
+			chunk->data[c].ToUnifiedFormat(chunk->size(), formats[c]);
+		}
+	}
+
+	idx_t Remaining() const {
+		return chunk ? chunk->size() - offset : 0;
+	}
+
+	optional_ptr<DataChunk> chunk;
+	vector<UnifiedVectorFormat> formats;
+	idx_t offset = 0;
+};
+
+// Walks a ColumnDataCollection one chunk at a time.
+struct RowCursor : public ChunkCursor {
+	explicit RowCursor(const ColumnDataCollection &collection_p) : collection(collection_p) {
+		collection.InitializeScan(scan_state);
+		collection.InitializeScanChunk(buffer);
+	}
+
+	//! Loads the next chunk if the current one is exhausted. Returns false at the end of the collection.
+	bool Ensure() {
+		while (Remaining() == 0) {
+			if (!collection.Scan(scan_state, buffer)) {
+				return false;
+			}
+			Load(buffer);
+		}
+		return true;
+	}
+
+	const ColumnDataCollection &collection;
+	ColumnDataScanState scan_state;
+	DataChunk buffer;
+};
+
+template <class T>
+static idx_t TypedMismatch(const UnifiedVectorFormat &left, idx_t left_offset, const UnifiedVectorFormat &right,
+                           idx_t right_offset, idx_t count) {
+	auto left_data = UnifiedVectorFormat::GetData<T>(left);
+	auto right_data = UnifiedVectorFormat::GetData<T>(right);
+	for (idx_t i = 0; i < count; i++) {
+		auto left_idx = left.sel->get_index(left_offset + i);
+		auto right_idx = right.sel->get_index(right_offset + i);
+		auto left_valid = left.validity.RowIsValid(left_idx);
+		if (left_valid != right.validity.RowIsValid(right_idx)) {
+			return i;
+		}
+		if (left_valid && !Equals::Operation<T>(left_data[left_idx], right_data[right_idx])) {
+			return i;
+		}
+	}
+	return count;
+}
+
+// Slow path for nested types and for columns whose types differ between the two sides. Differing types keep the
+// old semantics of comparing the rendered values, e.g. an INTEGER 3 matches a BIGINT 3.
+static idx_t ValueMismatch(Vector &left, idx_t left_offset, Vector &right, idx_t right_offset, idx_t count) {
+	auto same_type = left.GetType() == right.GetType();
+	for (idx_t i = 0; i < count; i++) {
+		auto left_value = left.GetValue(left_offset + i);
+		auto right_value = right.GetValue(right_offset + i);
+		if (same_type ? !Value::NotDistinctFrom(left_value, right_value)
+		              : left_value.ToString() != right_value.ToString()) {
+			return i;
+		}
+	}
+	return count;
+}
+
+// Returns the position of the first row in [0, count) at which the column differs, or count if it does not.
+static idx_t ColumnMismatch(Vector &left, const UnifiedVectorFormat &left_format, idx_t left_offset, Vector &right,
+                            const UnifiedVectorFormat &right_format, idx_t right_offset, idx_t count) {
+	if (left.GetType() != right.GetType()) {
+		return ValueMismatch(left, left_offset, right, right_offset, count);
+	}
+	switch (left.GetType().InternalType()) {
+	case PhysicalType::BOOL:
+		return TypedMismatch<bool>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::INT8:
+		return TypedMismatch<int8_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::INT16:
+		return TypedMismatch<int16_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::INT32:
+		return TypedMismatch<int32_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::INT64:
+		return TypedMismatch<int64_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::INT128:
+		return TypedMismatch<hugeint_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::UINT8:
+		return TypedMismatch<uint8_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::UINT16:
+		return TypedMismatch<uint16_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::UINT32:
+		return TypedMismatch<uint32_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::UINT64:
+		return TypedMismatch<uint64_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::UINT128:
+		return TypedMismatch<uhugeint_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::FLOAT:
+		return TypedMismatch<float>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::DOUBLE:
+		return TypedMismatch<double>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::INTERVAL:
+		return TypedMismatch<interval_t>(left_format, left_offset, right_format, right_offset, count);
+	case PhysicalType::VARCHAR:
+		return TypedMismatch<string_t>(left_format, left_offset, right_format, right_offset, count);
+	default:
+		return ValueMismatch(left, left_offset, right, right_offset, count);
+	}
+}
+
+// Compares the next count rows of both cursors and returns the first differing row, or count if all match.
+static idx_t RowsMismatch(ChunkCursor &left, ChunkCursor &right, idx_t count) {
+	for (idx_t c = 0; c < left.chunk->ColumnCount() && count > 0; c++) {
+		// Later columns only need to look at rows before the earliest mismatch found so far
+		count = ColumnMismatch(left.chunk->data[c], left.formats[c], left.offset, right.chunk->data[c],
+		                       right.formats[c], right.offset, count);
+	}
+	return count;
+}
+
+// Hashes each row of chunk. Columns whose type differs from hash_types are hashed as VARCHAR, which keeps the
+// rendered-value semantics of the typed comparison for mismatched column types.
+static void HashRows(DataChunk &chunk, const vector<LogicalType> &hash_types, Vector &hashes) {
+	auto count = chunk.size();
+	for (idx_t c = 0; c < chunk.ColumnCount(); c++) {
+		Vector *input = &chunk.data[c];
+		unique_ptr<Vector> cast_input;
+		if (input->GetType() != hash_types[c]) {
+			cast_input = make_uniq<Vector>(LogicalType::VARCHAR, count);
+			VectorOperations::DefaultCast(*input, *cast_input, count);
+			input = cast_input.get();
+		}
+		if (c == 0) {
+			VectorOperations::Hash(*input, hashes, count);
+		} else {
+			VectorOperations::CombineHash(hashes, *input, count);
+		}
+	}
+}
+
+void ResultFingerprint::Sink(DataChunk &chunk, idx_t limit) {
+	auto count = chunk.size();
+	if (count == 0) {
+		return;
+	}
+	Vector hashes(LogicalType::HASH, count);
+	HashRows(chunk, hash_types, hashes);
+	UnifiedVectorFormat hash_data;
+	hashes.ToUnifiedFormat(count, hash_data);
+	auto hash_values = UnifiedVectorFormat::GetData<hash_t>(hash_data);
+	for (idx_t i = 0; i < MinValue(count, limit); i++) {
+		auto hash = hash_values[hash_data.sel->get_index(i)];
+		// Wrapping sums are commutative; the second one over a remixed hash makes cancelling sums unlikely. Both come
+		// from the same 64-bit row hash, which bounds how well rows are told apart.
+		multiset.sum += hash;
+		multiset.mixed_sum += MurmurHash64(hash ^ 0x9E3779B97F4A7C15ULL);
+		sequence.Add(hash);
+		row_count++;
+		if (row_count % FINGERPRINT_CHECKPOINT_ROWS == 0) {
+			checkpoints.push_back(sequence);
+		}
+	}
+}
+
+// Types both sides are hashed as: the shared type, or VARCHAR for columns whose types differ.
+static vector<LogicalType> CompareTypes(const vector<LogicalType> &expected, const vector<LogicalType> &actual) {
+	vector<LogicalType> result;
+	for (idx_t c = 0; c < expected.size(); c++) {
+		result.push_back(expected[c] == actual[c] ? expected[c] : LogicalType::VARCHAR);
+	}
+	return result;
+}
+
+static std::vector<std::string> NormalizeColNames(const std::vector<std::string> &cols) {
+	std::vector<std::string> out;
+	out.reserve(cols.size());
+	for (auto &c : cols) {
+		out.push_back(StringUtil::Lower(c));
+	}
+	return out;
+}
+
+static bool EqualCols(const std::vector<std::string> &a, const std::vector<std::string> &b) {
+	if (a.size() != b.size()) return false;
+	for (idx_t i = 0; i < a.size(); i++) {
+		if (StringUtil::Lower(a[i]) != StringUtil::Lower(b[i])) return false;
+	}
+	return true;
+}
+
+static std::string ColList(const std::vector<std::string> &cols) {
+	std::ostringstream ss;
+	for (idx_t i = 0; i < cols.size(); i++) {
+		if (i) ss << ", ";
+		ss << cols[i];
+	}
+	return ss.str();
+}
+
+static unique_ptr<QueryResult> SafeQuery(Connection &con, const std::string &sql, std::string &err) {
+	auto res = con.Query(sql);
+	if (!res) {
+		err = "Unknown error executing query.";
+		return nullptr;
+	}
+	if (res->HasError()) {
+		err = res->GetError();
+		return nullptr;
+	}
+	return res;
+}
+
+// -------------------------- inner check connections --------------------------
+
+// An inner connection used to run checks, together with the per-connection setup already done on it.
+struct CheckConnection {
+	explicit CheckConnection(DatabaseInstance &db) : con(db) {
+	}
+
+	DatabaseInstance &Database() {
+		return *con.context->db;
+	}
+
+	Connection con;
+	//! Dataset version that USE dojo_data was run for; empty until then
+	std::string dataset_version;
+	bool profiling = false;
+};
+
+// Warm inner connections of one client connection. Checks take a connection out and return it afterwards, so the
+// client context, its settings and USE dojo_data are set up once instead of on every check. The pool hangs off the
+// client connection rather than the database: an inner connection keeps its database alive, so a pool owned by the
+// database would never let it shut down. Connections to a sandbox are pooled by the sandbox instead, so they are
+// closed along with it.
+class CheckConnectionPool : public ClientContextState {
+public:
+	static shared_ptr<CheckConnectionPool> Get(ClientContext &context) {
+		return context.registered_state->GetOrCreate<CheckConnectionPool>("dojo_check_connections");
+	}
+
+	unique_ptr<CheckConnection> Acquire(DatabaseInstance &db) {
+		{
+			lock_guard<mutex> guard(lock);
+			for (idx_t i = idle.size(); i > 0; i--) {
+				if (&idle[i - 1]->Database() == &db) {
+					auto check = std::move(idle[i - 1]);
+					idle.erase(idle.begin() + int64_t(i - 1));
+					return check;
+				}
+			}
+		}
+		return make_uniq<CheckConnection>(db);
+	}
+
+	// Resets the connection for the next check. Connections that cannot be reset, or exceed the number of
+	// concurrent checks the database can run, are closed instead.
+	void Release(unique_ptr<CheckConnection> check) {
+		check->con.context->interrupted = false;
+		if (check->con.HasActiveTransaction()) {
+			return;
+		}
+		if (check->profiling) {
+			std::string err;
+			if (!SafeQuery(check->con, "PRAGMA disable_profiling", err)) {
+				return;
+			}
+			check->profiling = false;
+		}
+		auto max_idle = idx_t(TaskScheduler::GetScheduler(*check->con.context).NumberOfThreads());
+		lock_guard<mutex> guard(lock);
+		idx_t idle_count = 0;
+		for (auto &other : idle) {
+			if (&other->Database() == &check->Database()) {
+				idle_count++;
+			}
+		}
+		if (idle_count < max_idle) {
+			idle.push_back(std::move(check));
+		}
+	}
+
+private:
+	mutex lock;
+	std::vector<unique_ptr<CheckConnection>> idle;
+};
+
+static Value DojoSetting(ClientContext &context, const std::string &name) {
+	Value result;
+	if (!context.TryGetCurrentSetting(name, result)) {
+		throw InternalException("Setting %s is not registered", name);
+	}
+	return result;
+}
+
+struct SandboxSettings {
+	idx_t instances = 0;
+	//! 0 leaves the number of threads at DuckDB's default
+	idx_t threads = 0;
+	//! Empty leaves the memory limit at DuckDB's default
+	std::string memory_limit;
+
+	static SandboxSettings Read(ClientContext &context) {
+		SandboxSettings settings;
+		settings.instances = DojoSetting(context, "dojo_sandbox_instances").GetValue<uint64_t>();
+		settings.threads = DojoSetting(context, "dojo_sandbox_threads").GetValue<uint64_t>();
+		settings.memory_limit = DojoSetting(context, "dojo_sandbox_memory_limit").ToString();
+		return settings;
+	}
+
+	bool operator==(const SandboxSettings &other) const {
+		return instances == other.instances && threads == other.threads && memory_limit == other.memory_limit;
+	}
+};
+
+// What checks need from the client connection they run for, read on that connection's thread. A ClientContext is not
+// thread-safe, so checks that run on scheduler threads (dojo_check_many jobs, dataset variants) only see this.
+struct CheckEnv {
+	static CheckEnv Capture(ClientContext &context) {
+		CheckEnv env;
+		env.db = context.db;
+		env.dojo = DojoState::Get(context);
+		env.pool = CheckConnectionPool::Get(context);
+		env.sandbox = SandboxSettings::Read(context);
+		env.timeout_ms = DojoSetting(context, "dojo_check_timeout_ms").GetValue<uint64_t>();
+		env.verdict_cache_size = DojoSetting(context, "dojo_verdict_cache_size").GetValue<uint64_t>();
+		env.plan_equivalence = DojoSetting(context, "dojo_plan_equivalence").GetValue<bool>();
+		env.interrupted = &context.interrupted;
+		return env;
+	}
+
+	shared_ptr<DatabaseInstance> db;
+	shared_ptr<DojoState> dojo;
+	//! The client connection's pool of inner connections to db
+	shared_ptr<CheckConnectionPool> pool;
+	SandboxSettings sandbox;
+	idx_t timeout_ms = 0;
+	idx_t verdict_cache_size = 0;
+	bool plan_equivalence = false;
+	//! Set when the client's statement is interrupted; the client context outlives the statement
+	optional_ptr<const std::atomic<bool>> interrupted;
+};
+
+struct Sandbox;
+
+// Checks a connection out of the client's pool for the lifetime of the guard. A sandboxed connection belongs to the
+// least busy sandbox database if dojo_sandbox_instances is set, and to the client's own database otherwise.
+class PooledConnection {
+public:
+	explicit PooledConnection(const CheckEnv &env, bool sandboxed = false);
+	~PooledConnection();
+
+	CheckConnection &Get() {
+		return *check;
+	}
+
+	Connection &Con() {
+		return check->con;
+	}
+
+	//! State of the database the connection belongs to
+	DojoState &Dojo() {
+		return *dojo;
+	}
+
+	bool InSandbox() const {
+		return sandbox != nullptr;
+	}
+
+private:
+	//! For a sandboxed connection this also keeps the sandbox alive, even if its set is dropped meanwhile; declared
+	//! first, so the sandbox outlives the state and connection below
+	shared_ptr<CheckConnectionPool> pool;
+	optional_ptr<Sandbox> sandbox;
+	shared_ptr<DojoState> dojo;
+	unique_ptr<CheckConnection> check;
+};
+
+// -------------------------- attempt log --------------------------
+
+void AttemptQueue::Run() {
+	unique_lock<mutex> guard(lock);
+	while (true) {
+		if (pending.empty()) {
+			if (stop) {
+				return;
+			}
+			wake.wait(guard);
+			continue;
+		}
+		// Let the batch fill up for a moment, unless a flush is waiting for it
+		if (!stop && flush_waiters == 0 && pending.size() < ATTEMPT_LOG_BATCH_SIZE) {
+			wake.wait_for(guard, ATTEMPT_LOG_FLUSH_INTERVAL);
+		}
+		vector<DojoAttempt> batch;
+		std::swap(batch, pending);
+		auto target = table;
+		guard.unlock();
+		std::string err;
+		Write(target, batch, err);
+		guard.lock();
+		handled += batch.size();
+		if (err.empty()) {
+			appended += batch.size();
+		} else {
+			error = err;
+		}
+		handled_cv.notify_all();
+	}
+}
+
+// Appends a batch in one statement on a connection of its own.
+void AttemptQueue::Write(const std::string &target, const vector<DojoAttempt> &batch, std::string &err) {
+	auto database = db.lock();
+	if (!database) {
+		err = "the database was closed";
+		return;
+	}
+	try {
+		Connection con(*database);
+		std::ostringstream ss;
+		ss << "INSERT INTO " << target << " VALUES ";
+		for (idx_t i = 0; i < batch.size(); i++) {
+			auto &attempt = batch[i];
+			ss << (i == 0 ? "(" : ", (") << Value::TIMESTAMP(attempt.attempted_at).ToSQLString() << ", "
+			   << Value(attempt.user_name).ToSQLString() << ", " << attempt.task_id << ", "
+			   << (attempt.ok ? "true" : "false") << ", " << Value::DOUBLE(attempt.latency_ms).ToSQLString() << ", "
+			   << (attempt.fingerprint.empty() ? Value() : Value(attempt.fingerprint)).ToSQLString() << ")";
+		}
+		SafeQuery(con, ss.str(), err);
+	} catch (std::exception &ex) {
+		err = ex.what();
+	}
+}
+
+void AttemptLog::Attach(Connection &con, const std::string &table) {
+	lock_guard<mutex> attach_guard(attach_lock);
+	if (Table() == table) {
+		return;
+	}
+	try {
+		// Attempts queued so far belong to the previous table
+		Flush();
+	} catch (std::exception &) {
+		// the previous table is no longer of interest
+	}
+
+	std::string err;
+	auto res = SafeQuery(con,
+	                     "CREATE TABLE IF NOT EXISTS " + table +
+	                         " (attempted_at TIMESTAMP, user_name VARCHAR, task_id INTEGER, ok BOOLEAN, "
+	                         "latency_ms DOUBLE, fingerprint VARCHAR)",
+	                     err);
+	if (res) {
+		res = SafeQuery(con,
+		                "SELECT user_name, task_id, count(*), count(*) FILTER (WHERE ok), min(latency_ms) FILTER "
+		                "(WHERE ok), min(attempted_at) FILTER (WHERE ok) FROM " +
+		                    table + " WHERE user_name IS NOT NULL AND task_id IS NOT NULL GROUP BY ALL",
+		                err);
+	}
+	if (!res) {
+		throw InvalidInputException("dojo_attempt_log: cannot log attempts to %s: %s", table, err);
+	}
+	std::unordered_map<std::string, DojoUserProgress> table_progress;
+	std::unordered_map<std::string, DojoStanding> table_standings;
+	while (auto chunk = res->Fetch()) {
+		for (idx_t r = 0; r < chunk->size(); r++) {
+			auto user_name = chunk->GetValue(0, r).ToString();
+			auto &task = table_progress[user_name][chunk->GetValue(1, r).GetValue<int32_t>()];
+			auto &standing = table_standings[user_name];
+			task.attempts = chunk->GetValue(2, r).GetValue<idx_t>();
+			task.passes = chunk->GetValue(3, r).GetValue<idx_t>();
+			standing.attempts += task.attempts;
+			if (task.passes == 0) {
+				continue;
+			}
+			auto best_latency = chunk->GetValue(4, r);
+			auto first_solved = chunk->GetValue(5, r);
+			task.best_latency_ms = best_latency.IsNull() ? 0 : best_latency.GetValue<double>();
+			task.first_solved_at = first_solved.IsNull() ? timestamp_t(0) : first_solved.GetValue<timestamp_t>();
+			standing.solved++;
+			standing.solved_latency_ms += task.best_latency_ms;
+			if (standing.solved == 1 || task.first_solved_at > standing.last_solved_at) {
+				standing.last_solved_at = task.first_solved_at;
+			}
+		}
+	}
+
+	lock_guard<mutex> guard(lock);
+	lock_guard<mutex> queue_guard(queue->lock);
+	// Attempts queued since the flush above are about to be written to the new table
+	for (auto &attempt : queue->pending) {
+		Apply(table_progress, table_standings, attempt);
+	}
+	progress = std::move(table_progress);
+	standings = std::move(table_standings);
+	queue->table = table;
+}
+
+// Turns on the query profiler of an inner connection without printing anything; ReadMetrics() picks up the numbers
+// of the last query that ran to completion.
+static void EnableProfiling(CheckConnection &check) {
+	if (check.profiling) {
+		return;
+	}
+	auto &con = check.con;
+	std::string err;
+	if (!SafeQuery(con, "PRAGMA enable_profiling = 'no_output'", err) ||
+	    !SafeQuery(con,
+	               "SET custom_profiling_settings = '{\"LATENCY\": \"true\", \"CUMULATIVE_ROWS_SCANNED\": \"true\", "
+	               "\"SYSTEM_PEAK_BUFFER_MEMORY\": \"true\", \"TOTAL_BYTES_READ\": \"true\", "
+	               "\"OPERATOR_TYPE\": \"true\", \"OPERATOR_CARDINALITY\": \"true\", \"OPERATOR_TIMING\": \"true\", "
+	               "\"EXTRA_INFO\": \"true\"}'",
+	               err)) {
+		throw InvalidInputException("Failed to enable profiling: %s", err);
+	}
+	check.profiling = true;
+}
+
+static idx_t ProfilerCount(const ProfilingInfo &info, MetricsType type) {
+	auto entry = info.metrics.find(type);
+	if (entry == info.metrics.end() || entry->second.IsNull()) {
+		return 0;
+	}
+	return entry->second.GetValue<idx_t>();
+}
+
+static QueryMetrics ReadMetrics(Connection &con) {
+	QueryMetrics metrics;
+	auto root = QueryProfiler::Get(*con.context).GetRoot();
+	if (!root) {
+		return metrics;
+	}
+	auto &info = root->GetProfilingInfo();
+	auto latency = info.metrics.find(MetricsType::LATENCY);
+	if (latency != info.metrics.end() && !latency->second.IsNull()) {
+		metrics.elapsed_ms = latency->second.GetValue<double>() * 1000.0;
+	}
+	metrics.rows_scanned = ProfilerCount(info, MetricsType::CUMULATIVE_ROWS_SCANNED);
+	metrics.peak_memory = ProfilerCount(info, MetricsType::SYSTEM_PEAK_BUFFER_MEMORY);
+	metrics.bytes_read = ProfilerCount(info, MetricsType::TOTAL_BYTES_READ);
+	metrics.valid = true;
+	return metrics;
+}
+
+static void FindDojoCalls(QueryNode &node, std::string &name);
+
+// Records in name the first dojo function called by expr or any subquery in it.
+static void FindDojoCalls(ParsedExpression &expr, std::string &name) {
+	if (!name.empty()) {
+		return;
+	}
+	if (expr.GetExpressionClass() == ExpressionClass::FUNCTION) {
+		auto &function = expr.Cast<FunctionExpression>();
+		if (StringUtil::StartsWith(StringUtil::Lower(function.function_name), "dojo_")) {
+			name = function.function_name;
+			return;
+		}
+	} else if (expr.GetExpressionClass() == ExpressionClass::SUBQUERY) {
+		FindDojoCalls(*expr.Cast<SubqueryExpression>().subquery->node, name);
+	}
+	ParsedExpressionIterator::EnumerateChildren(expr, [&](ParsedExpression &child) { FindDojoCalls(child, name); });
+}
+
+static void FindDojoCalls(QueryNode &node, std::string &name) {
+	ParsedExpressionIterator::EnumerateQueryNodeChildren(
+	    node, [&](unique_ptr<ParsedExpression> &child) { FindDojoCalls(*child, name); }, [](TableRef &) {});
+}
+
+// Only single SELECT statements are accepted, so a submission can never modify the shared dataset. Calls to the dojo
+// functions themselves (as table functions or scalars, anywhere in the query) are rejected as well: they set up
+// datasets, load tasks, reset statistics or grade queries, none of which a submission may do.
+static bool ValidateSubmission(const std::string &sql, std::string &err) {
+	Parser parser;
+	try {
+		parser.ParseQuery(sql);
+	} catch (std::exception &ex) {
+		ErrorData error(ex);
+		err = error.Message();
+		return false;
+	}
+	if (parser.statements.size() != 1 || parser.statements[0]->type != StatementType::SELECT_STATEMENT) {
+		err = "Only a single SELECT statement can be checked.";
+		return false;
+	}
+	std::string dojo_call;
+	FindDojoCalls(*parser.statements[0]->Cast<SelectStatement>().node, dojo_call);
+	if (!dojo_call.empty()) {
+		err = StringUtil::Format("Submissions cannot call %s().", dojo_call);
+		return false;
+	}
+	return true;
+}
+
+// Attaches catalog as a fresh, empty in-memory database, replacing any database of that name. This runs on a new
+// connection: the caller's one may have USE'd the catalog, and a connection cannot detach its default database.
+static bool AttachDatasetCatalog(Connection &con, const std::string &catalog, std::string &err) {
+	auto name = KeywordHelper::WriteOptionallyQuoted(catalog);
+	return SafeQuery(con, "DETACH DATABASE IF EXISTS " + name, err) &&
+	       SafeQuery(con, "ATTACH ':memory:' AS " + name, err);
+}
+
+// Marks a dataset catalog read-only once it is built, so neither the client's session nor a submission can modify
+// the rows that cached canonical results and the built-in fingerprints were derived from. In-memory databases cannot
+// be attached read-only, so the flag is set on the attached database directly; rebuilding re-attaches it.
+static void SealDatasetCatalog(Connection &con, const std::string &catalog) {
+	con.context->RunFunctionInTransaction([&]() {
+		auto db = DatabaseManager::Get(*con.context).GetDatabase(*con.context, catalog);
+		if (!db) {
+			throw InternalException("Dataset catalog %s is not attached", catalog);
+		}
+		db->SetReadOnlyDatabase();
+	});
+}
+
+static hugeint_t DucklingsChecksum(Connection &con) {
+	std::string err;
+	auto res = SafeQuery(con, DucklingsChecksumSQL(), err);
+	if (!res) {
+		throw InvalidInputException("Failed to checksum ducklings dataset: %s", err);
+	}
+	auto chunk = res->Fetch();
+	if (!chunk || chunk->size() == 0) {
+		throw InvalidInputException("Failed to checksum ducklings dataset: empty result");
+	}
+	return chunk->GetValue(0, 0).GetValue<hugeint_t>();
+}
+
+struct DatasetInfo {
+	std::string version;
+	DatasetSpec spec;
+	//! Whether this call (re)built the table
+	bool rebuilt = false;
+};
+
+// Builds the shared dataset if this database does not have the current version yet. Passing a spec switches the
+// database to that dataset; otherwise the one last set up (the starter dataset by default) is used. With verify
+// set, the stored version and content checksum are re-read from the catalog first, so a dropped or modified
+// dataset is rebuilt. Verifying or rebuilding waits for the checks that hold a lease on the dataset to finish.
+static DatasetInfo EnsureDucklings(DojoState &dojo, Connection &con, bool verify = false,
+                                  optional_ptr<const DatasetSpec> spec = nullptr) {
+	{
+		lock_guard<mutex> guard(dojo.dataset_lock);
+		if (spec) {
+			dojo.dataset_spec = *spec;
+		}
+		if (!verify && dojo.dataset_version == dojo.dataset_spec.Version()) {
+			DatasetInfo info;
+			info.spec = dojo.dataset_spec;
+			info.version = dojo.dataset_version;
+			return info;
+		}
+	}
+
+	auto rebuild = dojo.dataset_use.GetExclusiveLock();
+	lock_guard<mutex> guard(dojo.dataset_lock);
+	DatasetInfo info;
+	info.spec = dojo.dataset_spec;
+	info.version = info.spec.Version();
+	if (dojo.dataset_version == info.version) {
+		if (!verify) {
+			return info;
+		}
+		std::string err;
+		auto res = SafeQuery(con, "SELECT version, checksum FROM dojo_data.main.dojo_dataset", err);
+		if (res) {
+			auto chunk = res->Fetch();
+			if (chunk && chunk->size() == 1 && chunk->GetValue(0, 0).ToString() == info.version &&
+			    chunk->GetValue(1, 0).GetValue<hugeint_t>() == dojo.dataset_checksum &&
+			    DucklingsChecksum(con) == dojo.dataset_checksum) {
+				return info;
+			}
+		}
+	}
+
+	std::string err;
+	Connection builder(*con.context->db);
+	if (!AttachDatasetCatalog(builder, "dojo_data", err) || !SafeQuery(builder, info.spec.BuildSQL(), err)) {
+		// If setup fails, let the calling code return a message. Throwing here simplifies flow.
+		throw InvalidInputException("Failed to initialize ducklings dataset: %s", err);
+	}
+	auto checksum = DucklingsChecksum(builder);
+	if (!SafeQuery(builder,
+	               StringUtil::Format("CREATE TABLE dojo_data.main.dojo_dataset AS SELECT %s AS version, "
+	                                  "%s AS checksum",
+	                                  Value(info.version).ToSQLString(), Value::HUGEINT(checksum).ToSQLString()),
+	               err)) {
+		throw InvalidInputException("Failed to record ducklings dataset version: %s", err);
+	}
+	SealDatasetCatalog(builder, "dojo_data");
+	dojo.dataset_version = info.version;
+	dojo.dataset_checksum = checksum;
+	info.rebuilt = true;
+	return info;
+}
+
+// Points an inner connection at the shared dataset (or a variant of it in another catalog) so submissions can refer
+// to plain 'ducklings'. A pooled connection that already uses this version of the dataset is left as is.
+static void UseDucklings(CheckConnection &check, const std::string &dataset_version,
+                         const std::string &catalog = "dojo_data") {
+	if (check.dataset_version == dataset_version) {
+		return;
+	}
+	std::string err;
+	if (!SafeQuery(check.con, "USE " + KeywordHelper::WriteOptionallyQuoted(catalog), err)) {
+		throw InvalidInputException("Failed to select ducklings dataset: %s", err);
+	}
+	check.dataset_version = dataset_version;
+}
+
+// Checks the user's result against the canonical fingerprint while it is being fetched. Sink() returns false as soon
+// as the verdict is known, so a wrong or runaway query can be abandoned without running it to completion. Digests only
+// tell that the results differ; for ordered levels NeedsLocate() asks the caller to find the first differing row.
+class ResultChecker {
+public:
+	ResultChecker(const DojoTask &task_p, shared_ptr<const ResultFingerprint> expected_p)
+	    : task(task_p), expected(std::move(expected_p)) {
+		// Reading up to max_rows (when larger than the expected count) still tells "too many rows" apart from a
+		// plain row count mismatch.
+		row_limit = expected->row_count;
+		if (task.max_rows >= 0) {
+			row_limit = MaxValue<idx_t>(row_limit, idx_t(task.max_rows));
+		}
+	}
+
+	//! Checks the column shape. Returns false if the result can be rejected without fetching it.
+	bool Begin(const vector<string> &names, const vector<LogicalType> &types) {
+		if (!EqualCols(names, task.expected_columns) || names.size() != expected->types.size()) {
+			std::ostringstream ss;
+			ss << "Column mismatch. Expected columns: [" << ColList(task.expected_columns) << "], got: ["
+			   << ColList(names) << "].";
+			ss << " Tip: use aliases (AS ...) to match expected column names.";
+			return Reject(ss.str());
+		}
+		actual.hash_types = CompareTypes(expected->types, types);
+		return true;
+	}
+
+	//! Consumes the next chunk of the user's result. Returns false once the verdict is known.
+	bool Sink(DataChunk &chunk) {
+		if (row_count + chunk.size() > row_limit) {
+			// An ordered result that already differs within the expected rows is reported as a mismatch (with its
+			// first difference) rather than as too long: the rows up to the expected count are still compared.
+			if (task.requires_order && !NeedsExpectedRehash() && row_count < expected->row_count) {
+				actual.Sink(chunk, expected->row_count - row_count);
+				if (actual.sequence != expected->sequence) {
+					needs_locate = true;
+					return Reject(MismatchMessage(optional_idx()));
+				}
+			}
+			row_count = row_limit + 1;
+			truncated = true;
+			return false;
+		}
+		actual.Sink(chunk);
+		row_count += chunk.size();
+		if (task.requires_order && !NeedsExpectedRehash()) {
+			for (; checked < actual.checkpoints.size() && checked < expected->checkpoints.size(); checked++) {
+				if (actual.checkpoints[checked] != expected->checkpoints[checked]) {
+					needs_locate = true;
+					return Reject(MismatchMessage(optional_idx()));
+				}
+			}
+		}
+		return true;
+	}
+
+	//! Whether the expected fingerprint was hashed as other types than this result compares with. The caller then
+	//! passes one hashed as HashTypes() to SetExpected() before Finish().
+	bool NeedsExpectedRehash() const {
+		return !rejected && !truncated && actual.hash_types != expected->hash_types;
+	}
+
+	const vector<LogicalType> &HashTypes() const {
+		return actual.hash_types;
+	}
+
+	void SetExpected(shared_ptr<const ResultFingerprint> expected_p) {
+		expected = std::move(expected_p);
+	}
+
+	//! Takes the expected result as the user's, for a submission that is known to produce it without running it.
+	//! Begin() must have accepted the columns.
+	void AcceptExpected() {
+		actual.hash_types = expected->hash_types;
+		actual.multiset = expected->multiset;
+		actual.sequence = expected->sequence;
+		row_count = expected->row_count;
+		checked = expected->checkpoints.size();
+	}
+
+	//! Returns the final verdict once the result has been consumed (or abandoned).
+	std::string Finish(bool &ok_out) {
+		if (rejected) {
+			ok_out = false;
+			return message;
+		}
+		ok_out = false;
+		// On a generated dataset the canonical answer may legitimately exceed the level's max_rows; row_limit is
+		// never below the expected count.
+		if (task.max_rows >= 0 && row_count > row_limit) {
+			std::ostringstream ss;
+			ss << "Too many rows. This level expects at most " << row_limit << " row(s), but your query returned "
+			   << (truncated ? "more than " + std::to_string(row_limit) : std::to_string(row_count)) << ".";
+			ss << " Tip: use LIMIT " << row_limit << ".";
+			return ss.str();
+		}
+		if (row_count != expected->row_count) {
+			std::ostringstream ss;
+			ss << "Row count mismatch. Expected " << expected->row_count << " row(s), got "
+			   << (truncated ? "more than " + std::to_string(expected->row_count) : std::to_string(row_count))
+			   << ".";
+			ss << " Tip: check your WHERE / GROUP BY / LIMIT logic.";
+			return ss.str();
+		}
+		// Equal results always have equal digests, so a digest mismatch is an exact rejection
+		if (task.requires_order ? actual.sequence != expected->sequence : actual.multiset != expected->multiset) {
+			needs_locate = task.requires_order;
+			return MismatchMessage(optional_idx());
+		}
+		ok_out = true;
+		return "✅ Nice work, your query matches the expected output for this level.";
+	}
+
+	//! Whether the verdict is an ordered mismatch whose first differing row is not known yet
+	bool NeedsLocate() const {
+		return needs_locate;
+	}
+
+	//! Rows consumed so far; once truncated, one more than the number of rows that were acceptable.
+	idx_t RowCount() const {
+		return row_count;
+	}
+
+	idx_t ExpectedRowCount() const {
+		return expected->row_count;
+	}
+
+	//! Digest of the user's result as consumed so far, as compared for this level
+	std::string ActualFingerprint() const {
+		if (task.requires_order) {
+			return StringUtil::Format("%016llx%016llx", (unsigned long long)actual.sequence.low,
+			                          (unsigned long long)actual.sequence.high);
+		}
+		return StringUtil::Format("%016llx%016llx", (unsigned long long)actual.multiset.sum,
+		                          (unsigned long long)actual.multiset.mixed_sum);
+	}
+
+	std::string MismatchMessage(optional_idx row) const {
+		std::ostringstream ss;
+		ss << "Result mismatch. Your output does not match the expected result.";
+		if (task.requires_order) {
+			ss << " This level checks ordering, so make sure to include the ORDER BY from the goal.";
+		} else {
+			ss << " Note: this level does not require ordering.";
+		}
+		if (row.IsValid()) {
+			ss << " First difference at row " << (row.GetIndex() + 1) << ".";
+		}
+		return ss.str();
+	}
+
+private:
+	bool Reject(std::string message_p) {
+		rejected = true;
+		message = std::move(message_p);
+		return false;
+	}
+
+	const DojoTask &task;
+	shared_ptr<const ResultFingerprint> expected;
+	idx_t row_limit;
+	idx_t row_count = 0;
+	bool truncated = false;
+	bool rejected = false;
+	bool needs_locate = false;
+	std::string message;
+	ResultFingerprint actual;
+	//! Checkpoints compared so far
+	idx_t checked = 0;
+};
+
+// -------------------------- dojo_ducklings (table function) --------------------------
+
+// Deterministic synthetic ducklings: every row is a pure function of (seed, row number), so the generated table has
+// the same contents regardless of how many threads produced it.
+
+static const char *const DUCKLING_NAMES[] = {
+    "Daffy",   "Goldie",  "Daisy",   "Puddles", "Waddles", "Beakley", "Mallow",  "Nugget",  "Duke",    "Splash",
+    "Moss",    "Sunny",   "Quackers", "Pip",    "Biscuit", "Dottie",  "Pebble",  "Maple",   "Ziggy",   "Noodle",
+    "Clover",  "Drake",   "Feather", "Hazel",   "Juniper", "Kiwi",    "Lemon",   "Marble",  "Olive",   "Pickles",
+    "Rusty",   "Sprout",  "Tango",   "Waffles", "Willow",  "Bubbles", "Coco",    "Dumpling", "Fig",     "Ginger"};
+static constexpr idx_t DUCKLING_NAME_COUNT = sizeof(DUCKLING_NAMES) / sizeof(DUCKLING_NAMES[0]);
+
+struct DucklingColor {
+	const char *name;
+	uint32_t weight; // out of 100
+};
+static const DucklingColor DUCKLING_COLORS[] = {{"yellow", 40}, {"brown", 30}, {"green", 15}, {"blue", 10},
+                                                {"white", 5}};
+static constexpr idx_t DUCKLING_COLOR_COUNT = sizeof(DUCKLING_COLORS) / sizeof(DUCKLING_COLORS[0]);
+
+// Uniform double in [0, 1) from the top 53 bits of a hash
+static double UnitInterval(uint64_t hash) {
+	return double(hash >> 11) * (1.0 / double(uint64_t(1) << 53));
+}
+
+struct DojoDucklingsBindData : public TableFunctionData {
+	idx_t row_count = 0;
+	int64_t seed = DUCKLINGS_DEFAULT_SEED;
+};
+
+struct DojoDucklingsGlobalState : public GlobalTableFunctionState {
+	explicit DojoDucklingsGlobalState(idx_t max_threads_p) : max_threads(max_threads_p) {
+	}
+
+	idx_t MaxThreads() const override {
+		return max_threads;
+	}
+
+	std::atomic<idx_t> next_row {0};
+	idx_t max_threads;
+};
+
+static unique_ptr<FunctionData> DojoDucklingsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+	(void)context;
+	DatasetSpec spec;
+	spec.scale_factor = 1;
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "scale_factor") {
+			spec.scale_factor = kv.second.GetValue<double>();
+		} else if (kv.first == "seed") {
+			spec.seed = kv.second.GetValue<int64_t>();
+		}
+	}
+	if (spec.scale_factor <= 0) {
+		throw InvalidInputException("dojo_ducklings requires a scale_factor larger than 0");
+	}
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::INTEGER};
+	names = {"name", "color", "age"};
+
+	auto bind_data = make_uniq<DojoDucklingsBindData>();
+	bind_data->row_count = spec.GeneratedRows();
+	bind_data->seed = spec.seed;
+	return std::move(bind_data);
+}
+
+static unique_ptr<GlobalTableFunctionState> DojoDucklingsInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<DojoDucklingsBindData>();
+	auto vectors = (bind_data.row_count + STANDARD_VECTOR_SIZE - 1) / STANDARD_VECTOR_SIZE;
+	auto threads = idx_t(TaskScheduler::GetScheduler(context).NumberOfThreads());
+	return make_uniq<DojoDucklingsGlobalState>(MaxValue<idx_t>(1, MinValue<idx_t>(vectors, threads)));
+}
+
+static void DojoDucklingsFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	(void)context;
+	auto &bind_data = data_p.bind_data->Cast<DojoDucklingsBindData>();
+	auto &gstate = data_p.global_state->Cast<DojoDucklingsGlobalState>();
+
+	auto start = gstate.next_row.fetch_add(STANDARD_VECTOR_SIZE);
+	if (start >= bind_data.row_count) {
+		output.SetCardinality(0);
+		return;
+	}
+	auto count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, bind_data.row_count - start);
+
+	auto name_data = FlatVector::GetData<string_t>(output.data[0]);
+	auto color_data = FlatVector::GetData<string_t>(output.data[1]);
+	auto age_data = FlatVector::GetData<int32_t>(output.data[2]);
+	auto seed = uint64_t(bind_data.seed);
+	for (idx_t i = 0; i < count; i++) {
+		auto row_hash = MurmurHash64(seed ^ MurmurHash64(start + i));
+
+		// A few popular names and a long tail: squaring skews the uniform draw towards the front of the list
+		auto name_draw = UnitInterval(row_hash);
+		auto name = DUCKLING_NAMES[idx_t(name_draw * name_draw * double(DUCKLING_NAME_COUNT))];
+		name_data[i] = StringVector::AddString(output.data[0], name);
+
+		auto color_draw = uint32_t(MurmurHash64(row_hash ^ 0xC0102ULL) % 100);
+		const char *color = DUCKLING_COLORS[0].name;
+		for (auto &candidate : DUCKLING_COLORS) {
+			if (color_draw < candidate.weight) {
+				color = candidate.name;
+				break;
+			}
+			color_draw -= candidate.weight;
+		}
+		color_data[i] = StringVector::AddString(output.data[1], color);
+
+		// Ages 1-12, younger ducklings being more common
+		auto age_draw = UnitInterval(MurmurHash64(row_hash ^ 0xA6EULL));
+		age_data[i] = 1 + int32_t(12.0 * age_draw * std::sqrt(age_draw));
+	}
+	output.SetCardinality(count);
+}
+
+// -------------------------- dataset variants --------------------------
+
+// Small randomized variants of the starter dataset. dojo_check(variants := N) grades a submission on the first N of
+// them as well, so an answer hard-coded for the 12 starter rows does not pass. Apart from exact duplicate rows, names
+// and ages stay unique, which keeps the order of a correct answer to an ordered level well-defined.
+enum class VariantKind : uint8_t { SHUFFLED, PERTURBED, NULLS, DUPLICATES };
+static constexpr idx_t VARIANT_KIND_COUNT = 4;
+static constexpr idx_t MAX_DATASET_VARIANTS = 64;
+//! Bumped whenever DatasetVariant::Rows() produces different rows for the same variant
+static constexpr int32_t VARIANT_GENERATOR_VERSION = 1;
+
+struct VariantDuckling {
+	Value name;
+	Value color;
+	Value age;
+};
+
+struct DatasetVariant {
+	explicit DatasetVariant(idx_t index_p)
+	    : index(index_p), seed(MurmurHash64(uint64_t(DUCKLINGS_DEFAULT_SEED) ^ MurmurHash64(index_p + 1))) {
+	}
+
+	idx_t index;
+	uint64_t seed;
+
+	VariantKind Kind() const {
+		return VariantKind(index % VARIANT_KIND_COUNT);
+	}
+
+	std::string KindName() const {
+		switch (Kind()) {
+		case VariantKind::SHUFFLED:
+			return "shuffled";
+		case VariantKind::PERTURBED:
+			return "perturbed";
+		case VariantKind::NULLS:
+			return "with NULLs";
+		default:
+			return "with duplicate rows";
+		}
+	}
+
+	//! Each variant lives in its own in-memory catalog, so submissions can refer to plain 'ducklings' on it as well
+	std::string Catalog() const {
+		return "dojo_variant_" + std::to_string(index);
+	}
+
+	uint64_t Draw(uint64_t salt) const {
+		return MurmurHash64(seed ^ MurmurHash64(salt));
+	}
+
+	std::vector<VariantDuckling> Rows() const {
+		std::vector<VariantDuckling> rows;
+		for (auto &duckling : dojo_generated::STARTER_DUCKLINGS) {
+			rows.push_back({Value(duckling.name), Value(duckling.color), Value::INTEGER(duckling.age)});
+		}
+		if (Kind() != VariantKind::SHUFFLED) {
+			// A few more ducklings with names the starter dataset does not use, then fresh colors and a fresh
+			// permutation of the ages
+			auto starter_count = rows.size();
+			auto extra = Draw(1) % 6 + 1;
+			for (idx_t i = 0; i < extra; i++) {
+				auto name = DUCKLING_NAMES[starter_count + (Draw(2) + i) % (DUCKLING_NAME_COUNT - starter_count)];
+				rows.push_back({Value(name), Value(), Value()});
+			}
+			vector<int32_t> ages;
+			for (idx_t i = 0; i < rows.size(); i++) {
+				ages.push_back(int32_t(i + 1));
+			}
+			for (idx_t i = ages.size(); i > 1; i--) {
+				std::swap(ages[i - 1], ages[Draw(100 + i) % i]);
+			}
+			for (idx_t i = 0; i < rows.size(); i++) {
+				rows[i].color = Value(DUCKLING_COLORS[Draw(200 + i) % DUCKLING_COLOR_COUNT].name);
+				rows[i].age = Value::INTEGER(ages[i]);
+			}
+		}
+		if (Kind() == VariantKind::NULLS) {
+			// One NULL per column, on different rows, so NULLs never tie with each other
+			auto first = Draw(300) % rows.size();
+			rows[first].name = Value(LogicalType::VARCHAR);
+			rows[(first + 1) % rows.size()].color = Value(LogicalType::VARCHAR);
+			rows[(first + 2) % rows.size()].age = Value(LogicalType::INTEGER);
+		} else if (Kind() == VariantKind::DUPLICATES) {
+			auto first = Draw(400) % rows.size();
+			for (idx_t i = 0; i < 3; i++) {
+				rows.push_back(rows[(first + i) % rows.size()]);
+			}
+		}
+		for (idx_t i = rows.size(); i > 1; i--) {
+			std::swap(rows[i - 1], rows[Draw(500 + i) % i]);
+		}
+		return rows;
+	}
+
+	std::string BuildSQL() const {
+		std::ostringstream ss;
+		ss << "CREATE OR REPLACE TABLE " << Catalog()
+		   << ".main.ducklings AS SELECT name::VARCHAR AS name, color::VARCHAR AS color, age::INTEGER AS age FROM "
+		      "(VALUES ";
+		auto rows = Rows();
+		for (idx_t i = 0; i < rows.size(); i++) {
+			ss << (i == 0 ? "(" : ", (") << rows[i].name.ToSQLString() << ", " << rows[i].color.ToSQLString() << ", "
+			   << rows[i].age.ToSQLString() << ")";
+		}
+		ss << ") AS t(name, color, age)";
+		return ss.str();
+	}
+
+	std::string Version() const {
+		auto sql = BuildSQL();
+		std::ostringstream ss;
+		ss << std::hex << Hash(sql.c_str(), sql.size()) << "-variant" << VARIANT_GENERATOR_VERSION;
+		return ss.str();
+	}
+};
+
+// Version of a dataset catalog (the shared dataset, or a variant if one is given) as built in this database; empty if
+// it has not been built.
+static std::string BuiltDatasetVersion(DojoState &dojo, optional_ptr<const DatasetVariant> variant = nullptr) {
+	lock_guard<mutex> guard(dojo.dataset_lock);
+	if (!variant) {
+		return dojo.dataset_version;
+	}
+	auto entry = dojo.variant_versions.find(variant->index);
+	return entry == dojo.variant_versions.end() ? std::string() : entry->second;
+}
+
+// Builds the variant's catalog if this database does not have the current version of it yet, and returns that version.
+// Like a rebuild of the shared dataset, this waits for the checks that hold a lease on the dataset catalogs to finish.
+static std::string EnsureVariant(DojoState &dojo, Connection &con, const DatasetVariant &variant) {
+	auto version = variant.Version();
+	if (BuiltDatasetVersion(dojo, variant) == version) {
+		return version;
+	}
+	auto rebuild = dojo.dataset_use.GetExclusiveLock();
+	lock_guard<mutex> guard(dojo.dataset_lock);
+	auto entry = dojo.variant_versions.find(variant.index);
+	if (entry != dojo.variant_versions.end() && entry->second == version) {
+		return version;
+	}
+	std::string err;
+	Connection builder(*con.context->db);
+	if (!AttachDatasetCatalog(builder, variant.Catalog(), err) || !SafeQuery(builder, variant.BuildSQL(), err)) {
+		throw InvalidInputException("Failed to initialize dataset variant %llu: %s", (unsigned long long)variant.index,
+		                            err);
+	}
+	SealDatasetCatalog(builder, variant.Catalog());
+	dojo.variant_versions[variant.index] = version;
+	return version;
+}
+
+// -------------------------- sandbox databases --------------------------
+
+// The dataset the client database last set up, which its sandboxes mirror.
+static DatasetSpec CurrentDatasetSpec(DojoState &dojo) {
+	lock_guard<mutex> guard(dojo.dataset_lock);
+	return dojo.dataset_spec;
+}
+
+// A dedicated in-memory database that checks run in instead of the client's database. It has its own buffer pool,
+// threads and catalog, the dojo extension loaded and its own copy of the shared dataset.
+struct Sandbox {
+	explicit Sandbox(DBConfig &config) : db(nullptr, &config) {
+		// Generated datasets and variants are built with dojo_ducklings()
+		db.LoadStaticExtension<DojoExtension>();
+		Connection con(db);
+		dojo = DojoState::Get(*con.context);
+	}
+
+	//! Builds the dataset ahead of the first check that needs it
+	void Warm(const DatasetSpec &spec) {
+		Connection con(db);
+		EnsureDucklings(*dojo, con, false, &spec);
+	}
+
+	DuckDB db;
+	shared_ptr<DojoState> dojo;
+	//! Idle connections to db; declared after it, so they are closed before it shuts down
+	CheckConnectionPool connections;
+	//! Checks running in this sandbox right now
+	std::atomic<idx_t> active {0};
+};
+
+// The sandboxes of one client database for one combination of dojo_sandbox_* settings, created together and then
+// warmed with its dataset.
+class SandboxPool {
+public:
+	explicit SandboxPool(const SandboxSettings &settings_p) : settings(settings_p) {
+		for (idx_t i = 0; i < settings.instances; i++) {
+			DBConfig config;
+			if (settings.threads > 0) {
+				config.SetOptionByName("threads", Value::BIGINT(int64_t(settings.threads)));
+			}
+			if (!settings.memory_limit.empty()) {
+				config.SetOptionByName("memory_limit", Value(settings.memory_limit));
+			}
+			sandboxes.push_back(make_uniq<Sandbox>(config));
+		}
+	}
+
+	//! The sandbox with the fewest running checks; the caller releases it by decrementing active
+	Sandbox &Acquire() {
+		auto best = sandboxes[0].get();
+		for (auto &sandbox : sandboxes) {
+			if (sandbox->active.load() < best->active.load()) {
+				best = sandbox.get();
+			}
+		}
+		best->active++;
+		return *best;
+	}
+
+	void Warm(const DatasetSpec &spec) {
+		for (auto &sandbox : sandboxes) {
+			sandbox->Warm(spec);
+		}
+	}
+
+	const SandboxSettings settings;
+
+private:
+	vector<unique_ptr<Sandbox>> sandboxes;
+};
+
+// Sandbox sets a client database keeps. Connections with different dojo_sandbox_* settings each use their own set, so
+// they do not replace each other's sandboxes on every check; beyond this many, the least recently used set is dropped.
+static constexpr idx_t MAX_SANDBOX_SETS = 4;
+
+// The set with the given settings, moved to the front; null if there is none. The caller holds sandbox_lock.
+static shared_ptr<SandboxPool> FindSandboxes(DojoState &host, const SandboxSettings &settings) {
+	for (auto it = host.sandboxes.begin(); it != host.sandboxes.end(); it++) {
+		if ((*it)->settings == settings) {
+			host.sandboxes.splice(host.sandboxes.begin(), host.sandboxes, it);
+			return host.sandboxes.front();
+		}
+	}
+	return nullptr;
+}
+
+// The sandboxes that checks of this connection run in, or null if dojo_sandbox_instances is 0. They are created by
+// the first check with these settings, so the dataset they are warmed with is the one set up at that point. Creating
+// and warming them takes long, so it happens outside sandbox_lock and the set is only published under it: checks of
+// connections with other settings are not held up, and a check that finds the set still warming builds the dataset
+// of its sandbox itself (EnsureCheckDataset() waits for a warm-up already in progress). A dropped set shuts down,
+// together with its pooled connections, once the last check running in it finishes.
+static shared_ptr<SandboxPool> GetSandboxes(const SandboxSettings &settings, DojoState &host) {
+	if (settings.instances == 0) {
+		return nullptr;
+	}
+	{
+		lock_guard<mutex> guard(host.sandbox_lock);
+		auto existing = FindSandboxes(host, settings);
+		if (existing) {
+			return existing;
+		}
+	}
+
+	auto sandboxes = make_shared_ptr<SandboxPool>(settings);
+	{
+		lock_guard<mutex> guard(host.sandbox_lock);
+		auto existing = FindSandboxes(host, settings);
+		if (existing) {
+			// Another check published a set with these settings meanwhile; this one is dropped unused
+			return existing;
+		}
+		host.sandboxes.push_front(sandboxes);
+		if (host.sandboxes.size() > MAX_SANDBOX_SETS) {
+			host.sandboxes.pop_back();
+		}
+	}
+	sandboxes->Warm(CurrentDatasetSpec(host));
+	return sandboxes;
+}
+
+// Builds the shared dataset in the database the connection belongs to. A sandbox mirrors the dataset last set up in
+// the client database, so dojo_setup() applies to sandboxed checks as well.
+static std::string EnsureCheckDataset(DojoState &host, PooledConnection &check) {
+	if (!check.InSandbox()) {
+		return EnsureDucklings(host, check.Con()).version;
+	}
+	auto spec = CurrentDatasetSpec(host);
+	return EnsureDucklings(check.Dojo(), check.Con(), false, &spec).version;
+}
+
+// Builds the dataset a check runs on, or the variant if one is given, and leases it: the dataset catalogs of the
+// database the connection belongs to are not rebuilt until the lease is dropped. A check never takes a second lease
+// while it holds one, since a waiting rebuild holds off new leases. If the dataset was rebuilt between building and
+// leasing, it is built again.
+static std::string LeaseCheckDataset(DojoState &host, PooledConnection &check, DatasetLease &lease,
+                                     optional_ptr<const DatasetVariant> variant = nullptr) {
+	while (true) {
+		auto version =
+		    variant ? EnsureVariant(check.Dojo(), check.Con(), *variant) : EnsureCheckDataset(host, check);
+		lease = check.Dojo().dataset_use.GetSharedLock();
+		if (BuiltDatasetVersion(check.Dojo(), variant) == version) {
+			return version;
+		}
+		lease.reset();
+	}
+}
+
+PooledConnection::PooledConnection(const CheckEnv &env, bool sandboxed) {
+	dojo = env.dojo;
+	shared_ptr<SandboxPool> sandboxes;
+	if (sandboxed) {
+		sandboxes = GetSandboxes(env.sandbox, *dojo);
+	}
+	auto db = env.db.get();
+	if (sandboxes) {
+		sandbox = &sandboxes->Acquire();
+		dojo = sandbox->dojo;
+		db = sandbox->db.instance.get();
+		pool = shared_ptr<CheckConnectionPool>(sandboxes, &sandbox->connections);
+	}
+	try {
+		if (!pool) {
+			pool = env.pool;
+		}
+		check = pool->Acquire(*db);
+	} catch (...) {
+		if (sandbox) {
+			sandbox->active--;
+		}
+		throw;
+	}
+}
+
+PooledConnection::~PooledConnection() {
+	if (sandbox) {
+		sandbox->active--;
+	}
+	try {
+		pool->Release(std::move(check));
+	} catch (std::exception &) {
+		// the connection is simply closed
+	}
+}
+
+// -------------------------- dojo_setup (table function) --------------------------
+
+// Global state for table functions that emit exactly one row.
+struct DojoSingleRowState : public GlobalTableFunctionState {
+	bool done = false;
+};
+
+static unique_ptr<GlobalTableFunctionState> DojoSingleRowInit(ClientContext &context, TableFunctionInitInput &input) {
+	(void)context;
+	(void)input;
+	return make_uniq<DojoSingleRowState>();
+}
+
+struct DojoSetupBindData : public TableFunctionData {
+	DatasetSpec spec;
+};
+
+static unique_ptr<FunctionData> DojoSetupBind(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+	(void)context;
+	auto bind_data = make_uniq<DojoSetupBindData>();
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "scale_factor") {
+			bind_data->spec.scale_factor = kv.second.GetValue<double>();
+		} else if (kv.first == "seed") {
+			bind_data->spec.seed = kv.second.GetValue<int64_t>();
+		}
+	}
+	if (bind_data->spec.scale_factor < 0) {
+		throw InvalidInputException("dojo_setup: scale_factor must not be negative");
+	}
+	return_types.clear();
+	names.clear();
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("message");
+	return std::move(bind_data);
+}
+
+static void DojoSetupFunc(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
+	auto &bind_data = input.bind_data->Cast<DojoSetupBindData>();
+	auto &gstate = input.global_state->Cast<DojoSingleRowState>();
+	if (gstate.done) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	gstate.done = true;
+	output.SetCardinality(1);
+
+	string message;
+	try {
+		auto env = CheckEnv::Capture(context);
+		auto dojo = env.dojo;
+		PooledConnection check(env);
+		auto info = EnsureDucklings(*dojo, check.Con(), true, bind_data.spec);
+		// This connection's sandboxes are created, and every sandbox set switched to the new dataset, now rather than
+		// by the next check
+		GetSandboxes(env.sandbox, *dojo);
+		std::list<shared_ptr<SandboxPool>> sandboxes;
+		{
+			lock_guard<mutex> guard(dojo->sandbox_lock);
+			sandboxes = dojo->sandboxes;
+		}
+		for (auto &set : sandboxes) {
+			set->Warm(info.spec);
+		}
+		if (info.rebuilt) {
+			message = "Ducklings dataset loaded as read-only table dojo_data.ducklings (name, color, age). "
+			          "Run USE dojo_data; to query it as 'ducklings'.";
+			if (!info.spec.IsDefault()) {
+				message += StringUtil::Format(" Generated %llu rows (scale factor %s, seed %lld).",
+				                              (unsigned long long)info.spec.GeneratedRows(),
+				                              Value::DOUBLE(info.spec.scale_factor).ToString(),
+				                              (long long)info.spec.seed);
+			}
+		} else {
+			message = "Ducklings dataset is up to date (version " + info.version + ").";
+		}
+	} catch (std::exception &ex) {
+		message = std::string("Internal exception: ") + ex.what();
+	}
+
+	output.SetValue(0, 0, Value(message));
+}
+
+// -------------------------- dojo_tasks (table function) --------------------------
+
+// Output columns of dojo_tasks(), in order
+enum DojoTasksColumn : column_t {
+	TASKS_COL_TASK_ID,
+	TASKS_COL_LEVEL,
+	TASKS_COL_TITLE,
+	TASKS_COL_TOPIC,
+	TASKS_COL_DIFFICULTY,
+	TASKS_COL_GOAL,
+	TASKS_COL_BADGE,
+	TASKS_COL_REQUIRES_ORDER,
+	TASKS_COL_MAX_ROWS,
+	TASKS_COL_EXPECTED_COLUMNS
+};
+
+static int32_t TaskIntColumn(const DojoTask &task, column_t column) {
+	switch (column) {
+	case TASKS_COL_TASK_ID:
+		return task.task_id;
+	case TASKS_COL_LEVEL:
+		return task.level;
+	case TASKS_COL_DIFFICULTY:
+		return task.difficulty;
+	default:
+		return task.max_rows;
+	}
+}
+
+static const std::string &TaskStringColumn(const DojoTask &task, column_t column) {
+	switch (column) {
+	case TASKS_COL_TITLE:
+		return task.title;
+	case TASKS_COL_TOPIC:
+		return task.topic;
+	case TASKS_COL_GOAL:
+		return task.goal;
+	default:
+		return task.badge;
+	}
+}
+
+// A pushed-down predicate: column <comparison> constant, or column IN (constants)
+struct DojoTasksFilter {
+	column_t column;
+	ExpressionType comparison;
+	vector<Value> constants;
+
+	bool Matches(const DojoTask &task) const {
+		auto value = column == TASKS_COL_TOPIC ? Value(task.topic) : Value::INTEGER(TaskIntColumn(task, column));
+		if (comparison == ExpressionType::COMPARE_IN) {
+			for (auto &constant : constants) {
+				if (!constant.IsNull() && value == constant) {
+					return true;
+				}
+			}
+			return false;
+		}
+		// Comparing with NULL is never true
+		if (constants[0].IsNull()) {
+			return false;
+		}
+		switch (comparison) {
+		case ExpressionType::COMPARE_EQUAL:
+			return value == constants[0];
+		case ExpressionType::COMPARE_NOTEQUAL:
+			return value != constants[0];
+		case ExpressionType::COMPARE_LESSTHAN:
+			return value < constants[0];
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+			return value <= constants[0];
+		case ExpressionType::COMPARE_GREATERTHAN:
+			return value > constants[0];
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			return value >= constants[0];
+		default:
+			return true;
+		}
+	}
+};
+
+struct DojoTasksBindData : public TableFunctionData {
+	shared_ptr<const DojoTaskCatalog> catalog;
+	vector<DojoTasksFilter> filters;
+};
+
+struct DojoTasksGlobalState : public GlobalTableFunctionState {
+	idx_t offset = 0;
+	vector<column_t> column_ids;
+};
+
+static unique_ptr<FunctionData> DojoTasksBind(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+	(void)input;
+	return_types = {
+	    LogicalType::INTEGER, // task_id
+	    LogicalType::INTEGER, // level
+	    LogicalType::VARCHAR, // title
+	    LogicalType::VARCHAR, // topic
+	    LogicalType::INTEGER, // difficulty
+	    LogicalType::VARCHAR, // goal
+	    LogicalType::VARCHAR, // badge
+	    LogicalType::BOOLEAN, // requires_order
+	    LogicalType::INTEGER, // max_rows
+	    LogicalType::LIST(LogicalType::VARCHAR) // expected_columns
+	};
+	names = {
+	    "task_id",
+	    "level",
+	    "title",
+	    "topic",
+	    "difficulty",
+	    "goal",
+	    "badge",
+	    "requires_order",
+	    "max_rows",
+	    "expected_columns"
+	};
+	auto bind_data = make_uniq<DojoTasksBindData>();
+	bind_data->catalog = DojoState::Get(context)->Catalog();
+	return std::move(bind_data);
+}
+
+// Returns the filterable column a bare column reference of this scan points to, or an invalid index.
+static column_t TasksFilterColumn(LogicalGet &get, const Expression &expr) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+		return DConstants::INVALID_INDEX;
+	}
+	auto &colref = expr.Cast<BoundColumnRefExpression>();
+	if (colref.binding.table_index != get.table_index) {
+		return DConstants::INVALID_INDEX;
+	}
+	auto column = get.GetColumnIds()[colref.binding.column_index].GetPrimaryIndex();
+	if (column != TASKS_COL_LEVEL && column != TASKS_COL_TOPIC && column != TASKS_COL_DIFFICULTY) {
+		return DConstants::INVALID_INDEX;
+	}
+	return column;
+}
+
+// Takes comparisons and IN lists of level, topic and difficulty against constants out of the plan and applies them
+// while scanning the catalog; all other filters stay in the plan.
+static void DojoTasksPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                    vector<unique_ptr<Expression>> &filters) {
+	(void)context;
+	auto &bind_data = bind_data_p->Cast<DojoTasksBindData>();
+	for (idx_t i = 0; i < filters.size(); i++) {
+		auto &expr = *filters[i];
+		DojoTasksFilter filter;
+		if (expr.GetExpressionClass() == ExpressionClass::BOUND_COMPARISON) {
+			auto &comparison = expr.Cast<BoundComparisonExpression>();
+			filter.comparison = comparison.GetExpressionType();
+			if (filter.comparison == ExpressionType::COMPARE_DISTINCT_FROM ||
+			    filter.comparison == ExpressionType::COMPARE_NOT_DISTINCT_FROM) {
+				continue;
+			}
+			const Expression *constant = comparison.right.get();
+			filter.column = TasksFilterColumn(get, *comparison.left);
+			if (filter.column == DConstants::INVALID_INDEX) {
+				filter.column = TasksFilterColumn(get, *comparison.right);
+				filter.comparison = FlipComparisonExpression(filter.comparison);
+				constant = comparison.left.get();
+			}
+			if (filter.column == DConstants::INVALID_INDEX ||
+			    constant->GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+				continue;
+			}
+			filter.constants.push_back(constant->Cast<BoundConstantExpression>().value);
+		} else if (expr.GetExpressionType() == ExpressionType::COMPARE_IN) {
+			auto &in = expr.Cast<BoundOperatorExpression>();
+			filter.comparison = ExpressionType::COMPARE_IN;
+			filter.column = TasksFilterColumn(get, *in.children[0]);
+			if (filter.column == DConstants::INVALID_INDEX) {
+				continue;
+			}
+			bool all_constant = true;
+			for (idx_t c = 1; c < in.children.size(); c++) {
+				if (in.children[c]->GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+					all_constant = false;
+					break;
+				}
+				filter.constants.push_back(in.children[c]->Cast<BoundConstantExpression>().value);
+			}
+			if (!all_constant) {
+				continue;
+			}
+		} else {
+			continue;
+		}
+		bind_data.filters.push_back(std::move(filter));
+		filters.erase_at(i);
+		i--;
+	}
+}
+
+static unique_ptr<GlobalTableFunctionState> DojoTasksInit(ClientContext &context, TableFunctionInitInput &input) {
+	(void)context;
+	auto gstate = make_uniq<DojoTasksGlobalState>();
+	gstate->column_ids = input.column_ids;
+	return std::move(gstate);
+}
+
+static void DojoTasksFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	(void)context;
+	auto &bind_data = data_p.bind_data->Cast<DojoTasksBindData>();
+	auto &gstate = data_p.global_state->Cast<DojoTasksGlobalState>();
+	auto &tasks = bind_data.catalog->Tasks();
+
+	// Pick the next batch of matching tasks, then fill each projected column in one pass over it
+	vector<const DojoTask *> batch;
+	while (gstate.offset < tasks.size() && batch.size() < STANDARD_VECTOR_SIZE) {
+		auto &task = tasks[gstate.offset++];
+		bool matches = true;
+		for (auto &filter : bind_data.filters) {
+			if (!filter.Matches(task)) {
+				matches = false;
+				break;
+			}
+		}
+		if (matches) {
+			batch.push_back(&task);
+		}
+	}
+	auto count = batch.size();
+
+	for (idx_t col = 0; col < gstate.column_ids.size(); col++) {
+		auto &vec = output.data[col];
+		auto column = gstate.column_ids[col];
+		switch (column) {
+		case TASKS_COL_TASK_ID:
+		case TASKS_COL_LEVEL:
+		case TASKS_COL_DIFFICULTY:
+		case TASKS_COL_MAX_ROWS: {
+			auto data = FlatVector::GetData<int32_t>(vec);
+			for (idx_t i = 0; i < count; i++) {
+				data[i] = TaskIntColumn(*batch[i], column);
+			}
+			break;
+		}
+		case TASKS_COL_TITLE:
+		case TASKS_COL_TOPIC:
+		case TASKS_COL_GOAL:
+		case TASKS_COL_BADGE: {
+			auto data = FlatVector::GetData<string_t>(vec);
+			for (idx_t i = 0; i < count; i++) {
+				data[i] = StringVector::AddString(vec, TaskStringColumn(*batch[i], column));
+			}
+			break;
+		}
+		case TASKS_COL_REQUIRES_ORDER: {
+			auto data = FlatVector::GetData<bool>(vec);
+			for (idx_t i = 0; i < count; i++) {
+				data[i] = batch[i]->requires_order;
+			}
+			break;
+		}
+		case TASKS_COL_EXPECTED_COLUMNS: {
+			idx_t total = 0;
+			for (idx_t i = 0; i < count; i++) {
+				total += batch[i]->expected_columns.size();
+			}
+			ListVector::Reserve(vec, total);
+			auto entries = FlatVector::GetData<list_entry_t>(vec);
+			auto &child = ListVector::GetEntry(vec);
+			auto child_data = FlatVector::GetData<string_t>(child);
+			idx_t offset = 0;
+			for (idx_t i = 0; i < count; i++) {
+				auto &columns = batch[i]->expected_columns;
+				entries[i] = list_entry_t(offset, columns.size());
+				for (auto &name : columns) {
+					child_data[offset++] = StringVector::AddString(child, name);
+				}
+			}
+			ListVector::SetListSize(vec, total);
+			break;
+		}
+		default:
+			// row id requested by e.g. COUNT(*); dojo_tasks() has none
+			vec.SetVectorType(VectorType::CONSTANT_VECTOR);
+			ConstantVector::SetNull(vec, true);
+			break;
+		}
+	}
+	output.SetCardinality(count);
+}
+
+// -------------------------- dojo_hint (scalar) --------------------------
+
+static void DojoHintFunc(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto catalog = DojoState::Get(state.GetContext())->Catalog();
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto result_data = FlatVector::GetData<string_t>(result);
+
+	auto &task_id_vec = args.data[0];
+	auto &hint_level_vec = args.data[1];
+
+	UnifiedVectorFormat task_id_data;
+	UnifiedVectorFormat hint_level_data;
+	task_id_vec.ToUnifiedFormat(args.size(), task_id_data);
+	hint_level_vec.ToUnifiedFormat(args.size(), hint_level_data);
+
+	for (idx_t i = 0; i < args.size(); i++) {
+		auto task_idx = task_id_data.sel->get_index(i);
+		auto hint_idx = hint_level_data.sel->get_index(i);
+
+		if (!task_id_data.validity.RowIsValid(task_idx) || !hint_level_data.validity.RowIsValid(hint_idx)) {
+			result_data[i] = StringVector::AddString(result, "NULL input is not allowed.");
+			continue;
+		}
+
+		auto task_id = ((int32_t *)task_id_data.data)[task_idx];
+		auto hint_level = ((int32_t *)hint_level_data.data)[hint_idx];
+
+		auto task = catalog->Find(task_id);
+		if (!task) {
+			result_data[i] = StringVector::AddString(result, "Unknown task_id. Try: SELECT * FROM dojo_tasks();");
+			continue;
+		}
+		if (hint_level < 1) {
+			result_data[i] = StringVector::AddString(result, "Hint levels start at 1.");
+			continue;
+		}
+		if ((idx_t)hint_level > task->hints.size()) {
+			std::ostringstream ss;
+			ss << "No more hints. This level has " << task->hints.size() << " hint(s).";
+			result_data[i] = StringVector::AddString(result, ss.str());
+			continue;
+		}
+
+		result_data[i] = StringVector::AddString(result, task->hints[(idx_t)hint_level - 1]);
+	}
+}
+
+// -------------------------- canonical plans --------------------------
+
+// Prints an optimized logical plan in a form that two queries share when they compute the same result the same way.
+// Column references print as the expression they stand for, so aliases and projections that only pass columns
+// through disappear, and the operands of commutative operators and conjunctions are sorted. Plan() returns an empty
+// string for plans with operators or expressions it does not cover, and for anything volatile.
+class PlanCanonicalizer {
+public:
+	std::string Plan(LogicalOperator &root) {
+		auto tree = Operator(root);
+		if (!supported) {
+			return std::string();
+		}
+		std::ostringstream ss;
+		ss << "OUTPUT(";
+		auto bindings = root.GetColumnBindings();
+		for (idx_t i = 0; i < bindings.size(); i++) {
+			ss << (i == 0 ? "" : ", ") << Column(bindings[i]);
+			if (i < root.types.size()) {
+				ss << "::" << root.types[i].ToString();
+			}
+		}
+		ss << ")\n" << tree;
+		return supported ? ss.str() : std::string();
+	}
+
+private:
+	std::string Unsupported() {
+		supported = false;
+		return std::string();
+	}
+
+	std::string Column(const ColumnBinding &binding) {
+		auto entry = columns.find(Key(binding));
+		return entry == columns.end() ? Unsupported() : entry->second;
+	}
+
+	static std::string Key(const ColumnBinding &binding) {
+		return std::to_string(binding.table_index) + "." + std::to_string(binding.column_index);
+	}
+
+	//! Expressions joined in sorted order, for operands whose order does not matter
+	static std::string Sorted(vector<std::string> parts, const std::string &separator) {
+		std::sort(parts.begin(), parts.end());
+		std::string result;
+		for (idx_t i = 0; i < parts.size(); i++) {
+			result += (i == 0 ? "" : separator) + parts[i];
+		}
+		return result;
+	}
+
+	std::string Orders(const vector<BoundOrderByNode> &orders) {
+		std::string result;
+		for (idx_t i = 0; i < orders.size(); i++) {
+			auto &order = orders[i];
+			result += (i == 0 ? "" : ", ") + Expr(*order.expression) +
+			          (order.type == OrderType::DESCENDING ? " DESC" : " ASC") +
+			          (order.null_order == OrderByNullType::NULLS_FIRST ? " NULLS FIRST" : " NULLS LAST");
+		}
+		return result;
+	}
+
+	std::string Operator(LogicalOperator &op) {
+		vector<std::string> children;
+		for (auto &child : op.children) {
+			children.push_back(Operator(*child));
+		}
+		if (!supported) {
+			return std::string();
+		}
+		switch (op.type) {
+		case LogicalOperatorType::LOGICAL_GET:
+			return Get(op.Cast<LogicalGet>());
+		case LogicalOperatorType::LOGICAL_PROJECTION: {
+			// Transparent: its columns print as the expressions they compute
+			auto &projection = op.Cast<LogicalProjection>();
+			for (idx_t i = 0; i < projection.expressions.size(); i++) {
+				columns[Key(ColumnBinding(projection.table_index, i))] = Expr(*projection.expressions[i]);
+			}
+			return children[0];
+		}
+		case LogicalOperatorType::LOGICAL_FILTER: {
+			vector<std::string> predicates;
+			for (auto &expr : op.expressions) {
+				predicates.push_back(Expr(*expr));
+			}
+			return "FILTER(" + Sorted(std::move(predicates), " AND ") + ")\n" + children[0];
+		}
+		case LogicalOperatorType::LOGICAL_ORDER_BY:
+			return "ORDER(" + Orders(op.Cast<LogicalOrder>().orders) + ")\n" + children[0];
+		case LogicalOperatorType::LOGICAL_TOP_N: {
+			auto &top_n = op.Cast<LogicalTopN>();
+			return "TOP_N(" + Orders(top_n.orders) + "; " + std::to_string(top_n.limit) + " OFFSET " +
+			       std::to_string(top_n.offset) + ")\n" + children[0];
+		}
+		case LogicalOperatorType::LOGICAL_LIMIT: {
+			auto &limit = op.Cast<LogicalLimit>();
+			std::string result = "LIMIT(";
+			for (auto node : {&limit.limit_val, &limit.offset_val}) {
+				if (node->Type() == LimitNodeType::CONSTANT_VALUE) {
+					result += std::to_string(node->GetConstantValue());
+				} else if (node->Type() != LimitNodeType::UNSET) {
+					return Unsupported();
+				}
+				result += node == &limit.limit_val ? " OFFSET " : ")\n";
+			}
+			return result + children[0];
+		}
+		case LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY: {
+			auto &aggregate = op.Cast<LogicalAggregate>();
+			if (aggregate.grouping_sets.size() > 1 || !aggregate.grouping_functions.empty()) {
+				return Unsupported();
+			}
+			vector<std::string> groups;
+			for (idx_t i = 0; i < aggregate.groups.size(); i++) {
+				groups.push_back(Expr(*aggregate.groups[i]));
+			}
+			vector<std::string> aggregates;
+			for (idx_t i = 0; i < aggregate.expressions.size(); i++) {
+				aggregates.push_back(Expr(*aggregate.expressions[i]));
+			}
+			for (idx_t i = 0; i < groups.size(); i++) {
+				columns[Key(ColumnBinding(aggregate.group_index, i))] = groups[i];
+			}
+			for (idx_t i = 0; i < aggregates.size(); i++) {
+				columns[Key(ColumnBinding(aggregate.aggregate_index, i))] = aggregates[i];
+			}
+			return "AGGREGATE(" + Sorted(std::move(groups), ", ") + "; " + Sorted(std::move(aggregates), ", ") +
+			       ")\n" + children[0];
+		}
+		case LogicalOperatorType::LOGICAL_DISTINCT: {
+			auto &distinct = op.Cast<LogicalDistinct>();
+			if (distinct.distinct_type != DistinctType::DISTINCT) {
+				return Unsupported();
+			}
+			vector<std::string> targets;
+			for (auto &target : distinct.distinct_targets) {
+				targets.push_back(Expr(*target));
+			}
+			return "DISTINCT(" + Sorted(std::move(targets), ", ") + ")\n" + children[0];
+		}
+		default:
+			return Unsupported();
+		}
+	}
+
+	std::string Get(LogicalGet &get) {
+		auto table = get.GetTable();
+		std::ostringstream ss;
+		if (table) {
+			ss << "SCAN(" << table->ParentCatalog().GetName() << "." << table->schema.name << "." << table->name;
+		} else {
+			ss << "SCAN(" << get.function.name << "(";
+			for (idx_t i = 0; i < get.parameters.size(); i++) {
+				ss << (i == 0 ? "" : ", ") << get.parameters[i].ToSQLString();
+			}
+			vector<std::string> named;
+			for (auto &kv : get.named_parameters) {
+				named.push_back(kv.first + " := " + kv.second.ToSQLString());
+			}
+			ss << (get.parameters.empty() || named.empty() ? "" : ", ") << Sorted(std::move(named), ", ") << ")";
+		}
+		auto &column_ids = get.GetColumnIds();
+		vector<std::string> names;
+		for (idx_t i = 0; i < column_ids.size(); i++) {
+			std::string name;
+			if (column_ids[i].IsRowIdColumn()) {
+				name = "rowid";
+			} else if (column_ids[i].GetPrimaryIndex() < get.names.size()) {
+				name = get.names[column_ids[i].GetPrimaryIndex()];
+			} else {
+				return Unsupported();
+			}
+			columns[Key(ColumnBinding(get.table_index, i))] = "#" + std::to_string(canonical_scans) + "." + name;
+			names.push_back(name);
+		}
+		vector<std::string> filters;
+		for (auto &filter : get.table_filters.filters) {
+			if (filter.first >= names.size()) {
+				return Unsupported();
+			}
+			filters.push_back(filter.second->ToString(names[filter.first]));
+		}
+		ss << " AS #" << canonical_scans++ << "; " << Sorted(std::move(filters), " AND ") << ")";
+		return ss.str();
+	}
+
+	static std::string Children(const vector<std::string> &parts) {
+		std::string result;
+		for (idx_t i = 0; i < parts.size(); i++) {
+			result += (i == 0 ? "" : ", ") + parts[i];
+		}
+		return result;
+	}
+
+	std::string Expr(Expression &expr) {
+		if (!supported) {
+			return std::string();
+		}
+		if (expr.IsVolatile()) {
+			return Unsupported();
+		}
+		switch (expr.GetExpressionClass()) {
+		case ExpressionClass::BOUND_COLUMN_REF:
+			return Column(expr.Cast<BoundColumnRefExpression>().binding);
+		case ExpressionClass::BOUND_CONSTANT: {
+			auto &value = expr.Cast<BoundConstantExpression>().value;
+			return value.ToSQLString() + "::" + value.type().ToString();
+		}
+		case ExpressionClass::BOUND_COMPARISON: {
+			auto &comparison = expr.Cast<BoundComparisonExpression>();
+			auto type = comparison.GetExpressionType();
+			auto left = Expr(*comparison.left);
+			auto right = Expr(*comparison.right);
+			// a > b is b < a; operands go in sorted order
+			if (right < left) {
+				std::swap(left, right);
+				type = FlipComparisonExpression(type);
+			}
+			return "(" + left + " " + ExpressionTypeToOperator(type) + " " + right + ")";
+		}
+		case ExpressionClass::BOUND_CONJUNCTION: {
+			auto &conjunction = expr.Cast<BoundConjunctionExpression>();
+			vector<std::string> children;
+			for (auto &child : conjunction.children) {
+				children.push_back(Expr(*child));
+			}
+			auto separator = expr.GetExpressionType() == ExpressionType::CONJUNCTION_AND ? " AND " : " OR ";
+			return "(" + Sorted(std::move(children), separator) + ")";
+		}
+		case ExpressionClass::BOUND_OPERATOR: {
+			auto &op = expr.Cast<BoundOperatorExpression>();
+			vector<std::string> children;
+			for (auto &child : op.children) {
+				children.push_back(Expr(*child));
+			}
+			auto type = expr.GetExpressionType();
+			if ((type == ExpressionType::COMPARE_IN || type == ExpressionType::COMPARE_NOT_IN) && !children.empty()) {
+				// The list of an IN is a set
+				auto input = children[0];
+				children.erase(children.begin());
+				return ExpressionTypeToString(type) + "(" + input + "; " + Sorted(std::move(children), ", ") + ")";
+			}
+			return ExpressionTypeToString(type) + "(" + Children(children) + ")";
+		}
+		case ExpressionClass::BOUND_FUNCTION: {
+			auto &function = expr.Cast<BoundFunctionExpression>();
+			// bind data holds arguments folded at bind time (e.g. constant patterns) that the children do not show
+			if (function.bind_info) {
+				return Unsupported();
+			}
+			vector<std::string> children;
+			for (auto &child : function.children) {
+				children.push_back(Expr(*child));
+			}
+			auto &name = function.function.name;
+			if ((name == "+" || name == "*") && children.size() == 2) {
+				return "(" + Sorted(std::move(children), " " + name + " ") + ")::" + expr.return_type.ToString();
+			}
+			return name + "(" + Children(children) + ")::" + expr.return_type.ToString();
+		}
+		case ExpressionClass::BOUND_AGGREGATE: {
+			auto &aggregate = expr.Cast<BoundAggregateExpression>();
+			// bind data holds arguments such as the string_agg separator or the quantile fraction
+			if (aggregate.filter || aggregate.order_bys || aggregate.bind_info) {
+				return Unsupported();
+			}
+			vector<std::string> children;
+			for (auto &child : aggregate.children) {
+				children.push_back(Expr(*child));
+			}
+			return aggregate.function.name + "(" + (aggregate.IsDistinct() ? "DISTINCT " : "") + Children(children) +
+			       ")::" + expr.return_type.ToString();
+		}
+		case ExpressionClass::BOUND_CAST: {
+			auto &cast = expr.Cast<BoundCastExpression>();
+			return std::string(cast.try_cast ? "TRY_CAST(" : "CAST(") + Expr(*cast.child) + " AS " +
+			       expr.return_type.ToString() + ")";
+		}
+		case ExpressionClass::BOUND_BETWEEN: {
+			auto &between = expr.Cast<BoundBetweenExpression>();
+			return "BETWEEN(" + Expr(*between.input) + (between.lower_inclusive ? "; [" : "; (") +
+			       Expr(*between.lower) + ", " + Expr(*between.upper) + (between.upper_inclusive ? "])" : "))");
+		}
+		case ExpressionClass::BOUND_CASE: {
+			auto &case_expr = expr.Cast<BoundCaseExpression>();
+			std::string result = "CASE";
+			for (auto &check : case_expr.case_checks) {
+				result += " WHEN " + Expr(*check.when_expr) + " THEN " + Expr(*check.then_expr);
+			}
+			return result + " ELSE " + Expr(*case_expr.else_expr) + " END";
+		}
+		default:
+			return Unsupported();
+		}
+	}
+
+	bool supported = true;
+	//! What each column binding seen so far stands for
+	std::unordered_map<std::string, std::string> columns;
+	//! Scans are numbered in plan order, so a self-join tells its two sides apart
+	idx_t canonical_scans = 0;
+};
+
+// Binds and optimizes a query on the connection without running it. Returns its canonical plan, or an empty string if
+// it cannot be planned or its plan has no canonical form.
+static std::string CanonicalPlan(Connection &con, const std::string &sql, vector<string> &names,
+                                 vector<LogicalType> &types) {
+	std::string plan;
+	try {
+		auto &context = *con.context;
+		Parser parser(context.GetParserOptions());
+		parser.ParseQuery(sql);
+		if (parser.statements.size() != 1) {
+			return std::string();
+		}
+		context.RunFunctionInTransaction([&]() {
+			Planner planner(context);
+			planner.CreatePlan(std::move(parser.statements[0]));
+			names = planner.names;
+			types = planner.types;
+			Optimizer optimizer(*planner.binder, context);
+			auto optimized = optimizer.Optimize(std::move(planner.plan));
+			optimized->ResolveOperatorTypes();
+			PlanCanonicalizer canonicalizer;
+			plan = canonicalizer.Plan(*optimized);
+		});
+	} catch (std::exception &) {
+		return std::string();
+	}
+	return plan;
+}
+
+// Whether the submission optimizes to the canonical plan of the task's canonical query on the dataset the connection
+// uses. The canonical query is planned once per task and dataset. names and types receive the submission's columns.
+static bool MatchesCanonicalPlan(DojoState &dojo, CheckConnection &check, const DojoTask &task,
+                                 const std::string &dataset_version, const std::string &user_sql,
+                                 vector<string> &names, vector<LogicalType> &types) {
+	auto key = ExpectedResultCache::Key(task, dataset_version);
+	std::string expected_plan;
+	if (!dojo.plan_cache.Get(key, expected_plan)) {
+		vector<string> expected_names;
+		vector<LogicalType> expected_types;
+		expected_plan = CanonicalPlan(check.con, task.expected_sql, expected_names, expected_types);
+		dojo.plan_cache.Put(key, expected_plan);
+	}
+	if (expected_plan.empty()) {
+		return false;
+	}
+	return CanonicalPlan(check.con, user_sql, names, types) == expected_plan;
+}
+
+// -------------------------- dojo_check (table function) --------------------------
+
+// The table set by dojo_attempt_log, fully qualified: inner connections USE dojo_data, but an unqualified name
+// refers to the main schema of the user's current database. Empty if attempts are not logged.
+static std::string AttemptLogTable(ClientContext &context) {
+	auto setting = DojoSetting(context, "dojo_attempt_log").ToString();
+	if (setting.empty()) {
+		return "";
+	}
+	auto name = QualifiedName::Parse(setting);
+	if (name.catalog.empty()) {
+		name.catalog = DatabaseManager::GetDefaultDatabase(context);
+	}
+	if (name.schema.empty()) {
+		name.schema = DEFAULT_SCHEMA;
+	}
+	return KeywordHelper::WriteOptionallyQuoted(name.catalog) + "." +
+	       KeywordHelper::WriteOptionallyQuoted(name.schema) + "." + KeywordHelper::WriteOptionallyQuoted(name.name);
+}
+
+// Starts logging to the table set by dojo_attempt_log and returns the user attempts are recorded for, or an empty
+// string if attempts are not logged. Called at bind time, so a bad table name fails the statement before any check.
+static std::string AttachAttemptLog(ClientContext &context) {
+	auto table = AttemptLogTable(context);
+	if (table.empty()) {
+		return "";
+	}
+	auto dojo = DojoState::Get(context);
+	if (dojo->attempt_log.Table() != table) {
+		PooledConnection check(CheckEnv::Capture(context));
+		dojo->attempt_log.Attach(check.Con(), table);
+	}
+	auto user_name = DojoSetting(context, "dojo_user").ToString();
+	return user_name.empty() ? "anonymous" : user_name;
+}
+
+struct DojoCheckState : public TableFunctionData {
+	//! Keeps the task alive even if the catalog is reloaded while the statement runs
+	shared_ptr<const DojoTaskCatalog> catalog;
+	const DojoTask *task = nullptr;
+	std::string user_sql;
+	bool metrics = false;
+	//! Number of dataset variants to check on as well
+	idx_t variants = 0;
+	//! User the verdict is recorded for in the attempt log; empty if attempts are not logged
+	std::string attempt_user;
+};
+
+// Resolves a task in the current catalog, keeping the catalog snapshot in the bind data.
+static void BindTask(ClientContext &context, int32_t task_id, DojoCheckState &state) {
+	state.catalog = DojoState::Get(context)->Catalog();
+	state.task = state.catalog->Find(task_id);
+	if (!state.task) {
+		throw InvalidInputException("Unknown task_id %d. Try: SELECT * FROM dojo_tasks();", task_id);
+	}
+}
+
+static unique_ptr<FunctionData> DojoCheckBind(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 2) {
+		throw InvalidInputException("dojo_check requires 2 arguments: task_id (INTEGER), user_sql (VARCHAR)");
+	}
+	auto task_id = input.inputs[0].GetValue<int32_t>();
+	auto user_sql = input.inputs[1].ToString();
+
+	return_types = {
+	    LogicalType::BOOLEAN, // ok
+	    LogicalType::VARCHAR, // message
+	    LogicalType::UBIGINT, // expected_rows
+	    LogicalType::UBIGINT  // actual_rows
+	};
+	names = {"ok", "message", "expected_rows", "actual_rows"};
+
+	auto state = make_uniq<DojoCheckState>();
+	BindTask(context, task_id, *state);
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "metrics") {
+			state->metrics = BooleanValue::Get(kv.second);
+		} else if (kv.first == "variants") {
+			auto variants = kv.second.GetValue<int64_t>();
+			if (variants < 0 || idx_t(variants) > MAX_DATASET_VARIANTS) {
+				throw InvalidInputException("dojo_check: variants must be between 0 and %llu",
+				                            (unsigned long long)MAX_DATASET_VARIANTS);
+			}
+			state->variants = idx_t(variants);
+		}
+	}
+	state->attempt_user = AttachAttemptLog(context);
+	if (state->metrics) {
+		// Profiler numbers for the user query and the canonical one; NULL when the user query did not run to
+		// completion.
+		for (auto &side : {"user", "expected"}) {
+			return_types.push_back(LogicalType::DOUBLE);
+			names.push_back(std::string(side) + "_elapsed_ms");
+			return_types.push_back(LogicalType::UBIGINT);
+			names.push_back(std::string(side) + "_rows_scanned");
+			return_types.push_back(LogicalType::UBIGINT);
+			names.push_back(std::string(side) + "_peak_memory");
+			return_types.push_back(LogicalType::UBIGINT);
+			names.push_back(std::string(side) + "_bytes_read");
+		}
+		return_types.push_back(LogicalType::DOUBLE);
+		names.push_back("elapsed_ratio");
+	}
+	state->user_sql = user_sql;
+	return std::move(state);
+}
+
+// Fetches the next chunk of a (streaming) result. Errors raised while executing the rest of the query surface here.
+static bool FetchChunk(QueryResult &result, unique_ptr<DataChunk> &chunk, std::string &err,
+                       optional_ptr<ExceptionType> err_type = nullptr) {
+	try {
+		chunk = result.Fetch();
+	} catch (std::exception &ex) {
+		ErrorData error(ex);
+		err = error.Message();
+		if (err_type) {
+			*err_type = error.Type();
+		}
+		return false;
+	}
+	if (result.HasError()) {
+		err = result.GetError();
+		if (err_type) {
+			*err_type = result.GetErrorType();
+		}
+		return false;
+	}
+	return true;
+}
+
+// Runs a query and collects its result in blocks of the connection's buffer manager. A MaterializedQueryResult keeps
+// its rows on the heap, out of sight of the memory limit; these blocks count towards it and are spilled to the temp
+// directory once the database runs out of memory.
+static unique_ptr<ColumnDataCollection> BufferQuery(Connection &con, const std::string &sql, std::string &err) {
+	auto res = con.SendQuery(sql);
+	if (res->HasError()) {
+		err = res->GetError();
+		return nullptr;
+	}
+	auto collection = make_uniq<ColumnDataCollection>(BufferManager::GetBufferManager(*con.context), res->types);
+	ColumnDataAppendState append_state;
+	collection->InitializeAppend(append_state);
+	while (true) {
+		unique_ptr<DataChunk> chunk;
+		if (!FetchChunk(*res, chunk, err)) {
+			return nullptr;
+		}
+		if (!chunk || chunk->size() == 0) {
+			return collection;
+		}
+		collection->Append(append_state, *chunk);
+	}
+}
+
+// Runs a query to completion, dropping its result chunk by chunk.
+static bool DrainQuery(Connection &con, const std::string &sql, std::string &err) {
+	auto res = con.SendQuery(sql);
+	if (res->HasError()) {
+		err = res->GetError();
+		return false;
+	}
+	while (true) {
+		unique_ptr<DataChunk> chunk;
+		if (!FetchChunk(*res, chunk, err)) {
+			return false;
+		}
+		if (!chunk || chunk->size() == 0) {
+			return true;
+		}
+	}
+}
+
+// The canonical result of a built-in level on the starter dataset, as serialized at build time and hashed as
+// hash_types. Returns nullptr for other tasks, and for built-in ids whose expected_sql was replaced by a task pack.
+static shared_ptr<const ResultFingerprint> BuiltinExpectedFingerprint(const DojoTask &task,
+                                                               optional_ptr<const vector<LogicalType>> hash_types) {
+	auto index = dojo_generated::FindTask(task.task_id);
+	if (index < 0 || task.expected_sql != dojo_generated::TASKS[index].expected_sql) {
+		return nullptr;
+	}
+	auto &spec = dojo_generated::TASKS[index];
+	auto fingerprint = make_shared_ptr<ResultFingerprint>();
+	for (idx_t col = 0; col < spec.result_column_count; col++) {
+		fingerprint->col_names.push_back(spec.result_names[col]);
+		fingerprint->types.push_back(TransformStringToLogicalType(spec.result_types[col]));
+	}
+	fingerprint->hash_types =
+	    hash_types && hash_types->size() == fingerprint->types.size() ? *hash_types : fingerprint->types;
+	DataChunk chunk;
+	chunk.Initialize(Allocator::DefaultAllocator(), fingerprint->types);
+	for (idx_t row = 0; row < spec.result_row_count; row++) {
+		for (idx_t col = 0; col < spec.result_column_count; col++) {
+			auto cell = spec.result_cells[row * spec.result_column_count + col];
+			auto &type = fingerprint->types[col];
+			chunk.SetValue(col, chunk.size(), cell ? Value(cell).DefaultCastAs(type) : Value(type));
+		}
+		chunk.SetCardinality(chunk.size() + 1);
+		if (chunk.size() == STANDARD_VECTOR_SIZE) {
+			fingerprint->Sink(chunk);
+			chunk.Reset();
+		}
+	}
+	fingerprint->Sink(chunk);
+	return std::move(fingerprint);
+}
+
+// Returns the fingerprint of the task's canonical result, running expected_sql only when it is not cached yet. The
+// result is streamed into the fingerprint and never materialized. Built-in levels on the starter dataset are served
+// from their build-time results unless the canonical run's metrics are needed. hash_types overrides the types the
+// rows are hashed as (see ResultChecker::NeedsExpectedRehash()).
+static shared_ptr<const ResultFingerprint>
+GetExpectedFingerprint(DojoState &dojo, CheckConnection &check, const DojoTask &task,
+                       const std::string &dataset_version, std::string &err, bool need_metrics = false,
+                       optional_ptr<const vector<LogicalType>> hash_types = nullptr,
+                       optional_ptr<CheckSample> sample = nullptr) {
+	auto key = ExpectedResultCache::Key(task, dataset_version);
+	if (hash_types) {
+		key += "#";
+		for (auto &type : *hash_types) {
+			key += type.ToString() + ",";
+		}
+	}
+	auto cached = dojo.expected_cache.Get(key);
+	if (sample) {
+		sample->counters[idx_t(cached ? CheckCounter::CACHE_HITS : CheckCounter::CACHE_MISSES)]++;
+	}
+	if (cached && (cached->metrics.valid || !need_metrics)) {
+		return cached;
+	}
+	if (!cached && !need_metrics && dataset_version == DatasetSpec().Version()) {
+		auto builtin = BuiltinExpectedFingerprint(task, hash_types);
+		if (builtin) {
+			return dojo.expected_cache.Put(key, std::move(builtin));
+		}
+	}
+	// The canonical run is always profiled, so its metrics are cached alongside the fingerprint
+	EnableProfiling(check);
+	auto expected_res = check.con.SendQuery(task.expected_sql);
+	if (expected_res->HasError()) {
+		err = expected_res->GetError();
+		return nullptr;
+	}
+	auto fingerprint = make_shared_ptr<ResultFingerprint>();
+	fingerprint->col_names = expected_res->names;
+	fingerprint->types = expected_res->types;
+	fingerprint->hash_types =
+	    hash_types && hash_types->size() == expected_res->types.size() ? *hash_types : expected_res->types;
+	while (true) {
+		unique_ptr<DataChunk> chunk;
+		if (!FetchChunk(*expected_res, chunk, err)) {
+			return nullptr;
+		}
+		if (!chunk || chunk->size() == 0) {
+			break;
+		}
+		fingerprint->Sink(*chunk);
+	}
+	fingerprint->metrics = ReadMetrics(check.con);
+	return dojo.expected_cache.Put(key, std::move(fingerprint));
+}
+
+// Slow path of a failed ordered check: runs the canonical query and the user's query again and compares them row by
+// row. Only the canonical side is collected, in buffer-managed blocks that can spill; the user's result streams past
+// it. Returns the first differing row, or nothing if the results cannot be compared (e.g. the user's query is not
+// deterministic).
+static optional_idx LocateMismatch(Connection &con, const std::string &expected_sql, const std::string &user_sql) {
+	std::string err;
+	auto expected = BufferQuery(con, expected_sql, err);
+	if (!expected) {
+		return optional_idx();
+	}
+	RowCursor expected_cursor(*expected);
+	auto actual_res = con.SendQuery(user_sql);
+	if (actual_res->HasError()) {
+		return optional_idx();
+	}
+	idx_t row = 0;
+	while (true) {
+		unique_ptr<DataChunk> chunk;
+		if (!FetchChunk(*actual_res, chunk, err)) {
+			return optional_idx();
+		}
+		if (!chunk || chunk->size() == 0) {
+			// The user's result ended early: the first missing row differs
+			return expected_cursor.Ensure() ? optional_idx(row) : optional_idx();
+		}
+		ChunkCursor actual_cursor;
+		actual_cursor.Load(*chunk);
+		while (actual_cursor.Remaining() > 0) {
+			if (!expected_cursor.Ensure()) {
+				return optional_idx(row + actual_cursor.offset);
+			}
+			auto count = MinValue(expected_cursor.Remaining(), actual_cursor.Remaining());
+			auto mismatch = RowsMismatch(expected_cursor, actual_cursor, count);
+			if (mismatch < count) {
+				return optional_idx(row + actual_cursor.offset + mismatch);
+			}
+			expected_cursor.offset += count;
+			actual_cursor.offset += count;
+		}
+		row += chunk->size();
+	}
+}
+
+// Times the phases of one run of a check and records them, with the run's outcome counters, in the database's stats
+// when the run ends. The checks and passes counters and the total latency are recorded once per graded submission
+// by GradeSubmission() instead, however many runs (dataset variants, reruns) or cache hits grading it took.
+class CheckStatsRecorder {
+public:
+	CheckStatsRecorder(CheckStats &stats_p, int32_t task_id_p)
+	    : stats(stats_p), task_id(task_id_p), phase_start(std::chrono::steady_clock::now()) {
+	}
+
+	~CheckStatsRecorder() {
+		try {
+			stats.Record(task_id, sample);
+		} catch (std::exception &) {
+			// statistics are best effort
+		}
+	}
+
+	//! Adds the time since the previous phase ended to this phase
+	void EndPhase(CheckPhase phase) {
+		phase_start = EndPhase(phase, phase_start);
+	}
+
+	void Count(CheckCounter counter) {
+		sample.counters[idx_t(counter)]++;
+	}
+
+	void Abort(CheckAbortReason reason) {
+		switch (reason) {
+		case CheckAbortReason::TIMEOUT:
+			Count(CheckCounter::TIMEOUTS);
+			break;
+		case CheckAbortReason::MEMORY:
+			Count(CheckCounter::MEMORY_ABORTS);
+			break;
+		case CheckAbortReason::CANCELLED:
+			Count(CheckCounter::CANCELLATIONS);
+			break;
+		default:
+			break;
+		}
+	}
+
+	CheckSample &Sample() {
+		return sample;
+	}
+
+private:
+	std::chrono::steady_clock::time_point EndPhase(CheckPhase phase, std::chrono::steady_clock::time_point since) {
+		auto now = std::chrono::steady_clock::now();
+		auto idx = idx_t(phase);
+		sample.micros[idx] += uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(now - since).count());
+		sample.reached[idx] = true;
+		return now;
+	}
+
+	CheckStats &stats;
+	int32_t task_id;
+	std::chrono::steady_clock::time_point phase_start;
+	CheckSample sample;
+};
+
+// Budget for one check: the task's own limit, falling back to the dojo_check_timeout_ms setting. 0 means unlimited.
+// Memory has no per-check budget: the memory_limit of the database a check runs in applies to it.
+struct DojoCheckLimits {
+	idx_t timeout_ms = 0;
+
+	static DojoCheckLimits Resolve(const CheckEnv &env, const DojoTask &task) {
+		DojoCheckLimits limits;
+		limits.timeout_ms = task.timeout_ms >= 0 ? idx_t(task.timeout_ms) : env.timeout_ms;
+		return limits;
+	}
+};
+
+// Watches an inner connection for the duration of a check.
+class WatchGuard {
+public:
+	WatchGuard(CheckWatchdog &watchdog_p, ClientContext &inner, const CheckEnv &env, const DojoCheckLimits &limits)
+	    : watchdog(watchdog_p) {
+		watch.inner = &inner;
+		watch.cancelled = env.interrupted;
+		watch.has_deadline = limits.timeout_ms > 0;
+		watch.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.timeout_ms);
+		watchdog.Register(watch);
+	}
+
+	~WatchGuard() {
+		watchdog.Unregister(watch);
+	}
+
+	CheckAbortReason Reason() const {
+		return watch.reason.load();
+	}
+
+private:
+	CheckWatchdog &watchdog;
+	CheckWatchdog::Watch watch;
+};
+
+static std::string AbortMessage(CheckAbortReason reason, const DojoCheckLimits &limits) {
+	std::ostringstream ss;
+	switch (reason) {
+	case CheckAbortReason::TIMEOUT:
+		ss << "Time limit exceeded: your query ran longer than " << limits.timeout_ms << " ms and was stopped.";
+		ss << " Tip: look for accidental cross joins or unbounded recursion.";
+		break;
+	case CheckAbortReason::CANCELLED:
+		ss << "Check cancelled.";
+		break;
+	default:
+		break;
+	}
+	return ss.str();
+}
+
+// The user's query failed because the database it ran in reached its memory_limit. Other queries share that limit, so
+// the failure is not necessarily the submission's own.
+static std::string OutOfMemoryMessage(ClientContext &inner) {
+	std::ostringstream ss;
+	ss << "Out of memory: the database reached its memory_limit ("
+	   << StringUtil::BytesToHumanReadableString(BufferManager::GetBufferManager(inner).GetMaxMemory())
+	   << ") while your query ran. Other queries share that limit, so a retry may pass;";
+	ss << " if it keeps failing, look for accidental cross joins or unbounded recursion.";
+	return ss.str();
+}
+
+// Checks the submission on the shared dataset, or on a dataset variant if one is given.
+static DojoVerdict RunCheck(const CheckEnv &env, const DojoTask &task, const std::string &user_sql,
+                           bool collect_metrics = false, optional_ptr<const DatasetVariant> variant = nullptr) {
+	DojoVerdict verdict;
+	auto dojo = env.dojo;
+	CheckStatsRecorder stats(dojo->stats, task.task_id);
+	if (variant) {
+		stats.Count(CheckCounter::VARIANT_RUNS);
+	}
+	try {
+		PooledConnection check(env, true);
+		auto &con = check.Con();
+		auto limits = DojoCheckLimits::Resolve(env, task);
+
+		DatasetLease lease;
+		auto dataset_version = LeaseCheckDataset(*dojo, check, lease, variant);
+		if (variant) {
+			UseDucklings(check.Get(), dataset_version, variant->Catalog());
+		} else {
+			UseDucklings(check.Get(), dataset_version);
+		}
+		stats.EndPhase(CheckPhase::SETUP);
+
+		// Interrupts the inner connection when the time budget runs out or the outer statement is cancelled
+		WatchGuard watch(check.Dojo().watchdog, *con.context, env, limits);
+
+		std::string err;
+		auto expected = GetExpectedFingerprint(*dojo, check.Get(), task, dataset_version, err, collect_metrics,
+		                                       nullptr, &stats.Sample());
+		stats.EndPhase(CheckPhase::CANONICAL);
+		if (!expected) {
+			if (watch.Reason() != CheckAbortReason::NONE) {
+				stats.Abort(watch.Reason());
+				verdict.message = AbortMessage(watch.Reason(), limits);
+			} else {
+				stats.Count(CheckCounter::INTERNAL_ERRORS);
+				verdict.message = "Internal error: failed to compute expected result: " + err;
+			}
+			return verdict;
+		}
+		verdict.expected_rows = expected->row_count;
+		verdict.expected_metrics = expected->metrics;
+		auto valid = ValidateSubmission(user_sql, err);
+
+		// A submission whose optimized plan is the canonical query's computes the same result, so its verdict is
+		// known without running it. Runs with metrics need the user query's profile and always execute it.
+		vector<string> plan_names;
+		vector<LogicalType> plan_types;
+		if (valid && !collect_metrics && env.plan_equivalence &&
+		    MatchesCanonicalPlan(*dojo, check.Get(), task, dataset_version, user_sql, plan_names, plan_types)) {
+			stats.Count(CheckCounter::PLAN_MATCHES);
+			ResultChecker checker(task, expected);
+			if (checker.Begin(plan_names, plan_types)) {
+				checker.AcceptExpected();
+				verdict.fingerprint = checker.ActualFingerprint();
+			}
+			verdict.message = checker.Finish(verdict.ok);
+			verdict.actual_rows = checker.RowCount();
+			stats.EndPhase(CheckPhase::COMPARE);
+			verdict.reusable = true;
+			return verdict;
+		}
+		if (collect_metrics) {
+			EnableProfiling(check.Get());
+		}
+
+		// The user's result is streamed into a fingerprint chunk by chunk, so it is never materialized
+		unique_ptr<QueryResult> actual_res;
+		auto err_type = ExceptionType::INVALID;
+		if (valid) {
+			actual_res = con.SendQuery(user_sql);
+			if (actual_res->HasError()) {
+				err = actual_res->GetError();
+				err_type = actual_res->GetErrorType();
+				actual_res.reset();
+			}
+		}
+		ResultChecker checker(task, std::move(expected));
+		if (actual_res) {
+			auto pending = checker.Begin(actual_res->names, actual_res->types);
+			while (pending) {
+				unique_ptr<DataChunk> chunk;
+				if (!FetchChunk(*actual_res, chunk, err, &err_type)) {
+					actual_res.reset();
+					break;
+				}
+				if (!chunk || chunk->size() == 0) {
+					// The query ran to completion, so the profiler has its final numbers
+					if (collect_metrics) {
+						verdict.user_metrics = ReadMetrics(con);
+					}
+					verdict.fingerprint = checker.ActualFingerprint();
+					break;
+				}
+				pending = checker.Sink(*chunk);
+			}
+			if (!pending && actual_res) {
+				// Verdict is known: stop the rest of the query instead of running it to completion
+				con.Interrupt();
+			}
+		}
+		stats.EndPhase(CheckPhase::USER_QUERY);
+		if (watch.Reason() != CheckAbortReason::NONE) {
+			stats.Abort(watch.Reason());
+			verdict.message = AbortMessage(watch.Reason(), limits);
+			verdict.actual_rows = checker.RowCount();
+			return verdict;
+		}
+		if (!actual_res && err_type == ExceptionType::OUT_OF_MEMORY) {
+			// Depends on what else ran at the same time, so the verdict is not reused or logged
+			stats.Abort(CheckAbortReason::MEMORY);
+			verdict.message = OutOfMemoryMessage(*con.context);
+			verdict.actual_rows = checker.RowCount();
+			return verdict;
+		}
+		if (!actual_res) {
+			stats.Count(CheckCounter::USER_ERRORS);
+			std::ostringstream ss;
+			ss << "Your query failed to run: " << err;
+			ss << " Try: SELECT dojo_hint(" << task.task_id << ", 1);";
+			verdict.message = ss.str();
+			verdict.reusable = true;
+			return verdict;
+		}
+		actual_res.reset();
+		// The connection may have been interrupted above, and is about to run more queries
+		con.context->interrupted = false;
+
+		if (checker.NeedsExpectedRehash()) {
+			auto rehashed = GetExpectedFingerprint(*dojo, check.Get(), task, dataset_version, err, false,
+			                                       &checker.HashTypes(), &stats.Sample());
+			stats.EndPhase(CheckPhase::CANONICAL);
+			if (!rehashed) {
+				if (watch.Reason() != CheckAbortReason::NONE) {
+					stats.Abort(watch.Reason());
+					verdict.message = AbortMessage(watch.Reason(), limits);
+				} else {
+					stats.Count(CheckCounter::INTERNAL_ERRORS);
+					verdict.message = "Internal error: failed to compute expected result: " + err;
+				}
+				return verdict;
+			}
+			checker.SetExpected(std::move(rehashed));
+		}
+		verdict.message = checker.Finish(verdict.ok);
+		verdict.actual_rows = checker.RowCount();
+		if (checker.NeedsLocate()) {
+			auto row = LocateMismatch(con, task.expected_sql, user_sql);
+			if (watch.Reason() != CheckAbortReason::NONE) {
+				stats.Abort(watch.Reason());
+				verdict.message = AbortMessage(watch.Reason(), limits);
+				return verdict;
+			}
+			verdict.message = checker.MismatchMessage(row);
+		}
+		stats.EndPhase(CheckPhase::COMPARE);
+		verdict.reusable = true;
+	} catch (std::exception &ex) {
+		stats.Count(CheckCounter::INTERNAL_ERRORS);
+		verdict.ok = false;
+		verdict.message = std::string("Internal exception: ") + ex.what();
+	}
+	return verdict;
+}
+
+// The submission as DuckDB's parser reads it, printed back, so whitespace, comments, keyword case and the quoting of
+// string literals make no difference. Returns false if it is not a single statement that parses.
+static bool NormalizeSubmission(const std::string &sql, std::string &normalized) {
+	try {
+		Parser parser;
+		parser.ParseQuery(sql);
+		if (parser.statements.size() != 1) {
+			return false;
+		}
+		normalized = parser.statements[0]->ToString();
+		return true;
+	} catch (std::exception &) {
+		return false;
+	}
+}
+
+// Version of the dataset a check runs on, without building it.
+static std::string CurrentDatasetVersion(DojoState &dojo, optional_ptr<const DatasetVariant> variant) {
+	if (variant) {
+		return variant->Version();
+	}
+	lock_guard<mutex> guard(dojo.dataset_lock);
+	return dojo.dataset_spec.Version();
+}
+
+static std::string VerdictKey(const DojoTask &task, const std::string &dataset_version, const DojoCheckLimits &limits,
+                              const std::string &normalized_sql) {
+	std::ostringstream ss;
+	ss << ExpectedResultCache::Key(task, dataset_version) << "|" << (task.requires_order ? "o" : "u") << task.max_rows
+	   << "|" << ColList(task.expected_columns) << "|" << limits.timeout_ms << "|"
+	   << normalized_sql;
+	return ss.str();
+}
+
+// Checks the submission like RunCheck(), reusing the verdict of an identical submission that was checked recently or
+// is being checked right now. Runs with metrics are always checked afresh.
+static DojoVerdict CheckSubmission(const CheckEnv &env, const DojoTask &task, const std::string &user_sql,
+                                   bool collect_metrics = false,
+                                   optional_ptr<const DatasetVariant> variant = nullptr) {
+	auto capacity = env.verdict_cache_size;
+	std::string normalized;
+	if (collect_metrics || capacity == 0 || !NormalizeSubmission(user_sql, normalized)) {
+		return RunCheck(env, task, user_sql, collect_metrics, variant);
+	}
+	auto dojo = env.dojo;
+	auto limits = DojoCheckLimits::Resolve(env, task);
+	auto key = VerdictKey(task, CurrentDatasetVersion(*dojo, variant), limits, normalized);
+	bool leader;
+	auto flight = dojo->verdict_cache.Join(key, capacity, leader);
+	if (leader) {
+		auto verdict = RunCheck(env, task, user_sql, false, variant);
+		dojo->verdict_cache.Finish(key, flight, verdict);
+		return verdict;
+	}
+
+	CheckSample sample;
+	bool waited;
+	if (!flight->Wait(*env.interrupted, waited)) {
+		sample.counters[idx_t(CheckCounter::CANCELLATIONS)]++;
+		dojo->stats.Record(task.task_id, sample);
+		DojoVerdict verdict;
+		verdict.message = AbortMessage(CheckAbortReason::CANCELLED, limits);
+		return verdict;
+	}
+	if (!flight->verdict.reusable) {
+		// That run was aborted or failed, which says nothing about this one
+		return RunCheck(env, task, user_sql, false, variant);
+	}
+	sample.counters[idx_t(CheckCounter::VERDICT_CACHE_HITS)]++;
+	if (waited) {
+		sample.counters[idx_t(CheckCounter::COALESCED)]++;
+	}
+	dojo->stats.Record(task.task_id, sample);
+	return flight->verdict;
+}
+
+// Checks the submission on one dataset variant, as a task of the scheduler.
+class DojoVariantCheckTask : public BaseExecutorTask {
+public:
+	DojoVariantCheckTask(TaskExecutor &executor, const CheckEnv &env_p, const DojoTask &task_p,
+	                     const std::string &user_sql_p, const DatasetVariant &variant_p, DojoVerdict &verdict_p)
+	    : BaseExecutorTask(executor), env(env_p), task(task_p), user_sql(user_sql_p), variant(variant_p),
+	      verdict(verdict_p) {
+	}
+
+	void ExecuteTask() override {
+		verdict = CheckSubmission(env, task, user_sql, false, &variant);
+	}
+
+private:
+	const CheckEnv &env;
+	const DojoTask &task;
+	const std::string &user_sql;
+	const DatasetVariant &variant;
+	DojoVerdict &verdict;
+};
+
+// Checks the submission on the shared dataset and on the first variant_count dataset variants, each on its own
+// inner connection and scheduler thread. Passes only if every check passes; rows and metrics are those of the shared
+// dataset.
+static DojoVerdict RunVariantChecks(const CheckEnv &env, const DojoTask &task, const std::string &user_sql,
+                                    bool collect_metrics, idx_t variant_count) {
+	vector<DatasetVariant> variants;
+	for (idx_t i = 0; i < variant_count; i++) {
+		variants.emplace_back(i);
+	}
+	vector<DojoVerdict> variant_verdicts(variant_count);
+	TaskExecutor executor(TaskScheduler::GetScheduler(*env.db));
+	for (idx_t i = 0; i < variant_count; i++) {
+		executor.ScheduleTask(
+		    make_uniq<DojoVariantCheckTask>(executor, env, task, user_sql, variants[i], variant_verdicts[i]));
+	}
+	// The check on the shared dataset runs on this thread meanwhile
+	auto verdict = CheckSubmission(env, task, user_sql, collect_metrics);
+	executor.WorkOnTasks();
+	if (!verdict.ok) {
+		return verdict;
+	}
+	for (idx_t i = 0; i < variant_count; i++) {
+		if (!variant_verdicts[i].ok) {
+			verdict.ok = false;
+			verdict.message = StringUtil::Format(
+			    "Your query matches the expected output on the ducklings dataset, but not on randomized variant %llu "
+			    "(%s) of it, so it may depend on the exact starter rows. %s",
+			    (unsigned long long)(i + 1), variants[i].KindName(), variant_verdicts[i].message);
+			return verdict;
+		}
+	}
+	return verdict;
+}
+
+// Grades a submission and, when attempt_user is set, queues the attempt for the attempt log.
+static DojoVerdict GradeSubmission(const CheckEnv &env, const DojoTask &task, const std::string &user_sql,
+                                   const std::string &attempt_user, bool collect_metrics = false,
+                                   idx_t variant_count = 0) {
+	auto start = std::chrono::steady_clock::now();
+	auto verdict = variant_count > 0 ? RunVariantChecks(env, task, user_sql, collect_metrics, variant_count)
+	                                 : CheckSubmission(env, task, user_sql, collect_metrics);
+	auto dojo = env.dojo;
+	CheckSample sample;
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	sample.micros[idx_t(CheckPhase::TOTAL)] =
+	    uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+	sample.reached[idx_t(CheckPhase::TOTAL)] = true;
+	sample.counters[idx_t(CheckCounter::CHECKS)]++;
+	if (verdict.ok) {
+		sample.counters[idx_t(CheckCounter::PASSES)]++;
+	}
+	dojo->stats.Record(task.task_id, sample);
+	// Checks stopped by the time budget, cancelled or out of memory, and internal errors, say nothing about the
+	// submission: memory is shared with concurrent work, so running out of it can be down to other queries. Only
+	// verdicts that depend on the submission alone are logged as attempts.
+	if (!attempt_user.empty() && verdict.reusable) {
+		DojoAttempt attempt;
+		attempt.attempted_at = Timestamp::GetCurrentTimestamp();
+		attempt.user_name = attempt_user;
+		attempt.task_id = task.task_id;
+		attempt.ok = verdict.ok;
+		attempt.latency_ms =
+		    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		attempt.fingerprint = verdict.fingerprint;
+		dojo->attempt_log.Record(std::move(attempt));
+	}
+	return verdict;
+}
+
+static void DojoCheckFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.bind_data->Cast<DojoCheckState>();
+	auto &gstate = data_p.global_state->Cast<DojoSingleRowState>();
+	if (gstate.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	gstate.done = true;
+
+	auto verdict = GradeSubmission(CheckEnv::Capture(context), *state.task, state.user_sql, state.attempt_user,
+	                               state.metrics, state.variants);
+	output.SetValue(0, 0, Value::BOOLEAN(verdict.ok));
+	output.SetValue(1, 0, Value(verdict.message));
+	output.SetValue(2, 0, Value::UBIGINT(verdict.expected_rows));
+	output.SetValue(3, 0, Value::UBIGINT(verdict.actual_rows));
+	if (state.metrics) {
+		idx_t col = 4;
+		for (auto metrics : {&verdict.user_metrics, &verdict.expected_metrics}) {
+			auto valid = verdict.user_metrics.valid && metrics->valid;
+			output.SetValue(col++, 0, valid ? Value::DOUBLE(metrics->elapsed_ms) : Value());
+			output.SetValue(col++, 0, valid ? Value::UBIGINT(metrics->rows_scanned) : Value());
+			output.SetValue(col++, 0, valid ? Value::UBIGINT(metrics->peak_memory) : Value());
+			output.SetValue(col++, 0, valid ? Value::UBIGINT(metrics->bytes_read) : Value());
+		}
+		auto &user = verdict.user_metrics;
+		auto &expected = verdict.expected_metrics;
+		auto has_ratio = user.valid && expected.valid && expected.elapsed_ms > 0;
+		output.SetValue(col, 0, has_ratio ? Value::DOUBLE(user.elapsed_ms / expected.elapsed_ms) : Value());
+	}
+	output.SetCardinality(1);
+}
+
+// -------------------------- dojo_check_many (table in-out function) --------------------------
+
+struct DojoCheckManyData : public TableFunctionData {
+	shared_ptr<const DojoTaskCatalog> catalog;
+	std::string attempt_user;
+};
+
+static unique_ptr<FunctionData> DojoCheckManyBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.input_table_types.size() != 3) {
+		throw InvalidInputException(
+		    "dojo_check_many requires a table with 3 columns: submission_id, task_id (INTEGER), sql (VARCHAR)");
+	}
+	return_types = {
+	    input.input_table_types[0], // submission_id, passed through
+	    LogicalType::INTEGER,       // task_id
+	    LogicalType::BOOLEAN,       // ok
+	    LogicalType::VARCHAR,       // message
+	    LogicalType::UBIGINT,       // expected_rows
+	    LogicalType::UBIGINT        // actual_rows
+	};
+	names = {input.input_table_names[0], "task_id", "ok", "message", "expected_rows", "actual_rows"};
+
+	auto bind_data = make_uniq<DojoCheckManyData>();
+	bind_data->catalog = DojoState::Get(context)->Catalog();
+	bind_data->attempt_user = AttachAttemptLog(context);
+	return std::move(bind_data);
+}
+
+struct DojoCheckJob {
+	optional_ptr<const DojoTask> task;
+	std::string user_sql;
+	DojoVerdict verdict;
+};
+
+// Grades jobs of a shared batch until none are left. Several of these run on the scheduler's worker threads.
+class DojoCheckJobTask : public BaseExecutorTask {
+public:
+	DojoCheckJobTask(TaskExecutor &executor, const CheckEnv &env_p, vector<DojoCheckJob> &jobs_p,
+	                 std::atomic<idx_t> &next_job_p, const std::string &attempt_user_p)
+	    : BaseExecutorTask(executor), env(env_p), jobs(jobs_p), next_job(next_job_p), attempt_user(attempt_user_p) {
+	}
+
+	void ExecuteTask() override {
+		while (true) {
+			auto job_idx = next_job++;
+			if (job_idx >= jobs.size()) {
+				return;
+			}
+			auto &job = jobs[job_idx];
+			if (job.task) {
+				job.verdict = GradeSubmission(env, *job.task, job.user_sql, attempt_user);
+			}
+		}
+	}
+
+private:
+	const CheckEnv &env;
+	vector<DojoCheckJob> &jobs;
+	std::atomic<idx_t> &next_job;
+	const std::string &attempt_user;
+};
+
+static OperatorResultType DojoCheckManyFunc(ExecutionContext &context, TableFunctionInput &data_p, DataChunk &input,
+                                            DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoCheckManyData>();
+	auto count = input.size();
+	vector<DojoCheckJob> jobs(count);
+	vector<Value> task_ids(count);
+	for (idx_t r = 0; r < count; r++) {
+		auto &job = jobs[r];
+		auto task_id = input.GetValue(1, r);
+		auto user_sql = input.GetValue(2, r);
+		if (task_id.IsNull() || user_sql.IsNull()) {
+			job.verdict.message = "NULL input is not allowed.";
+			continue;
+		}
+		if (!task_id.DefaultTryCastAs(LogicalType::INTEGER)) {
+			job.verdict.message = "task_id must be an INTEGER.";
+			continue;
+		}
+		task_ids[r] = task_id;
+		job.task = bind_data.catalog->Find(task_id.GetValue<int32_t>());
+		if (!job.task) {
+			job.verdict.message = "Unknown task_id. Try: SELECT * FROM dojo_tasks();";
+			continue;
+		}
+		job.user_sql = user_sql.ToString();
+	}
+
+	// Each check is an independent inner query, so the batch is spread over the scheduler's threads
+	auto &client = context.client;
+	auto env = CheckEnv::Capture(client);
+	std::atomic<idx_t> next_job {0};
+	auto task_count = MinValue<idx_t>(count, NumericCast<idx_t>(TaskScheduler::GetScheduler(client).NumberOfThreads()));
+	TaskExecutor executor(client);
+	for (idx_t t = 0; t < task_count; t++) {
+		executor.ScheduleTask(make_uniq<DojoCheckJobTask>(executor, env, jobs, next_job, bind_data.attempt_user));
+	}
+	executor.WorkOnTasks();
+
+	output.data[0].Reference(input.data[0]);
+	for (idx_t r = 0; r < count; r++) {
+		auto &verdict = jobs[r].verdict;
+		output.SetValue(1, r, task_ids[r]);
+		output.SetValue(2, r, Value::BOOLEAN(verdict.ok));
+		output.SetValue(3, r, Value(verdict.message));
+		output.SetValue(4, r, Value::UBIGINT(verdict.expected_rows));
+		output.SetValue(5, r, Value::UBIGINT(verdict.actual_rows));
+	}
+	output.SetCardinality(count);
+	return OperatorResultType::NEED_MORE_INPUT;
+}
+
+// -------------------------- dojo_progress / dojo_leaderboard (table functions) --------------------------
+
+struct DojoProgressData : public TableFunctionData {
+	shared_ptr<const DojoTaskCatalog> catalog;
+	std::string user_name;
+};
+
+// Rows of a table function with a small output, all computed by the first call from in-memory state.
+struct DojoRowsState : public GlobalTableFunctionState {
+	bool computed = false;
+	vector<vector<Value>> rows;
+	idx_t offset = 0;
+};
+
+static unique_ptr<GlobalTableFunctionState> DojoRowsInit(ClientContext &context, TableFunctionInitInput &input) {
+	(void)context;
+	(void)input;
+	return make_uniq<DojoRowsState>();
+}
+
+static void EmitRows(DojoRowsState &state, DataChunk &output) {
+	idx_t count = 0;
+	while (state.offset < state.rows.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &row = state.rows[state.offset];
+		for (idx_t col = 0; col < row.size(); col++) {
+			output.SetValue(col, count, row[col]);
+		}
+		state.offset++;
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+static unique_ptr<FunctionData> DojoProgressBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+	return_types = {
+	    LogicalType::INTEGER,   // task_id
+	    LogicalType::INTEGER,   // level
+	    LogicalType::VARCHAR,   // title
+	    LogicalType::UBIGINT,   // attempts
+	    LogicalType::UBIGINT,   // passes
+	    LogicalType::BOOLEAN,   // solved
+	    LogicalType::DOUBLE,    // best_latency_ms of a passing attempt
+	    LogicalType::TIMESTAMP  // first_solved_at
+	};
+	names = {"task_id", "level", "title", "attempts", "passes", "solved", "best_latency_ms", "first_solved_at"};
+
+	auto bind_data = make_uniq<DojoProgressData>();
+	bind_data->catalog = DojoState::Get(context)->Catalog();
+	bind_data->user_name = AttachAttemptLog(context);
+	if (bind_data->user_name.empty()) {
+		throw InvalidInputException("dojo_progress: attempts are not logged. Try: SET dojo_attempt_log = "
+		                            "'dojo_attempts';");
+	}
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "user") {
+			bind_data->user_name = kv.second.ToString();
+		}
+	}
+	return std::move(bind_data);
+}
+
+static void DojoProgressFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoProgressData>();
+	auto &state = data_p.global_state->Cast<DojoRowsState>();
+	if (!state.computed) {
+		state.computed = true;
+		auto progress = DojoState::Get(context)->attempt_log.Progress(bind_data.user_name);
+		for (auto &task : bind_data.catalog->Tasks()) {
+			DojoTaskProgress task_progress;
+			auto entry = progress.find(task.task_id);
+			if (entry != progress.end()) {
+				task_progress = entry->second;
+			}
+			auto solved = task_progress.passes > 0;
+			state.rows.push_back({Value::INTEGER(task.task_id), Value::INTEGER(task.level), Value(task.title),
+			                      Value::UBIGINT(task_progress.attempts), Value::UBIGINT(task_progress.passes),
+			                      Value::BOOLEAN(solved),
+			                      solved ? Value::DOUBLE(task_progress.best_latency_ms) : Value(LogicalType::DOUBLE),
+			                      solved ? Value::TIMESTAMP(task_progress.first_solved_at)
+			                             : Value(LogicalType::TIMESTAMP)});
+		}
+	}
+	EmitRows(state, output);
+}
+
+static unique_ptr<FunctionData> DojoLeaderboardBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+	(void)input;
+	return_types = {
+	    LogicalType::UBIGINT,  // rank: users with as many solved tasks and the same total latency share a rank
+	    LogicalType::VARCHAR,  // user_name
+	    LogicalType::UBIGINT,  // solved
+	    LogicalType::UBIGINT,  // attempts
+	    LogicalType::DOUBLE,   // solved_latency_ms: sum of the best passing latency of each solved task
+	    LogicalType::TIMESTAMP // last_solved_at
+	};
+	names = {"rank", "user_name", "solved", "attempts", "solved_latency_ms", "last_solved_at"};
+	if (AttachAttemptLog(context).empty()) {
+		throw InvalidInputException("dojo_leaderboard: attempts are not logged. Try: SET dojo_attempt_log = "
+		                            "'dojo_attempts';");
+	}
+	return make_uniq<TableFunctionData>();
+}
+
+// Most solved tasks first, then lowest total latency
+static bool RanksBefore(const DojoStanding &left, const DojoStanding &right) {
+	if (left.solved != right.solved) {
+		return left.solved > right.solved;
+	}
+	return left.solved_latency_ms < right.solved_latency_ms;
+}
+
+static void DojoLeaderboardFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.global_state->Cast<DojoRowsState>();
+	if (!state.computed) {
+		state.computed = true;
+		auto standings = DojoState::Get(context)->attempt_log.Standings();
+		std::sort(standings.begin(), standings.end(), [](const std::pair<std::string, DojoStanding> &left,
+		                                                 const std::pair<std::string, DojoStanding> &right) {
+			if (RanksBefore(left.second, right.second)) {
+				return true;
+			}
+			if (RanksBefore(right.second, left.second)) {
+				return false;
+			}
+			return left.first < right.first;
+		});
+		idx_t rank = 0;
+		for (idx_t i = 0; i < standings.size(); i++) {
+			auto &standing = standings[i].second;
+			if (i == 0 || RanksBefore(standings[i - 1].second, standing)) {
+				rank = i + 1;
+			}
+			state.rows.push_back({Value::UBIGINT(rank), Value(standings[i].first), Value::UBIGINT(standing.solved),
+			                      Value::UBIGINT(standing.attempts), Value::DOUBLE(standing.solved_latency_ms),
+			                      standing.solved > 0 ? Value::TIMESTAMP(standing.last_solved_at)
+			                                          : Value(LogicalType::TIMESTAMP)});
+		}
+	}
+	EmitRows(state, output);
+}
+
+// -------------------------- dojo_flush_attempts (table function) --------------------------
+
+static unique_ptr<FunctionData> DojoFlushAttemptsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+	(void)context;
+	(void)input;
+	return_types = {LogicalType::UBIGINT};
+	names = {"written"};
+	return make_uniq<TableFunctionData>();
+}
+
+static void DojoFlushAttemptsFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &gstate = data_p.global_state->Cast<DojoSingleRowState>();
+	if (gstate.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	gstate.done = true;
+
+	output.SetValue(0, 0, Value::UBIGINT(DojoState::Get(context)->attempt_log.Flush()));
+	output.SetCardinality(1);
+}
+
+// -------------------------- dojo_submit / dojo_result / dojo_results (table functions) --------------------------
+
+// Settings a check reads from its connection. dojo_submit() captures them, so a queued submission is graded with the
+// budget and sandboxes of the connection that submitted it.
+static const char *const GRADING_SETTINGS[] = {"dojo_check_timeout_ms",  "dojo_verdict_cache_size",
+                                               "dojo_plan_equivalence",  "dojo_sandbox_instances",
+                                               "dojo_sandbox_threads",   "dojo_sandbox_memory_limit"};
+
+void GradingQueue::Run() {
+	unique_lock<mutex> guard(lock);
+	while (!stop) {
+		if (pending.empty()) {
+			wake.wait(guard);
+			continue;
+		}
+		auto job = std::move(pending.front());
+		pending.pop_front();
+		tickets[job.ticket].status = GradingStatus::RUNNING;
+		guard.unlock();
+		auto verdict = Grade(job);
+		guard.lock();
+		auto &entry = tickets[job.ticket];
+		entry.status = GradingStatus::DONE;
+		entry.finished_at = Timestamp::GetCurrentTimestamp();
+		entry.sequence = next_sequence++;
+		entry.verdict = std::move(verdict);
+		finished.push_back(job.ticket);
+		while (finished.size() > GRADING_RESULT_RETENTION) {
+			tickets.erase(finished.front());
+			finished.pop_front();
+		}
+		graded_cv.notify_all();
+	}
+}
+
+// Grades a submission on a connection of its own, with the settings of the connection that submitted it.
+DojoVerdict GradingQueue::Grade(const GradingJob &job) {
+	DojoVerdict verdict;
+	auto database = db.lock();
+	if (!database) {
+		verdict.message = "Internal error: the database was closed.";
+		return verdict;
+	}
+	try {
+		Connection con(*database);
+		for (auto &setting : job.settings) {
+			std::string err;
+			if (!SafeQuery(con, "SET " + setting.first + " = " + setting.second.ToSQLString(), err)) {
+				throw InvalidInputException("Failed to apply %s: %s", setting.first, err);
+			}
+		}
+		auto env = CheckEnv::Capture(*con.context);
+		verdict = GradeSubmission(env, *job.task, job.user_sql, job.attempt_user, false, job.variants);
+	} catch (std::exception &ex) {
+		verdict.ok = false;
+		verdict.message = std::string("Internal exception: ") + ex.what();
+	}
+	return verdict;
+}
+
+static unique_ptr<FunctionData> DojoSubmitBind(ClientContext &context, TableFunctionBindInput &input,
+                                              vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 2) {
+		throw InvalidInputException("dojo_submit requires 2 arguments: task_id (INTEGER), user_sql (VARCHAR)");
+	}
+	return_types = {LogicalType::UBIGINT};
+	names = {"ticket"};
+
+	auto state = make_uniq<DojoCheckState>();
+	BindTask(context, input.inputs[0].GetValue<int32_t>(), *state);
+	state->user_sql = input.inputs[1].ToString();
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "variants") {
+			auto variants = kv.second.GetValue<int64_t>();
+			if (variants < 0 || idx_t(variants) > MAX_DATASET_VARIANTS) {
+				throw InvalidInputException("dojo_submit: variants must be between 0 and %llu",
+				                            (unsigned long long)MAX_DATASET_VARIANTS);
+			}
+			state->variants = idx_t(variants);
+		}
+	}
+	state->attempt_user = AttachAttemptLog(context);
+	return std::move(state);
+}
+
+static void DojoSubmitFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoCheckState>();
+	auto &gstate = data_p.global_state->Cast<DojoSingleRowState>();
+	if (gstate.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	gstate.done = true;
+
+	auto workers = DojoSetting(context, "dojo_grading_workers").GetValue<uint64_t>();
+	if (workers == 0) {
+		throw InvalidInputException("dojo_submit: dojo_grading_workers must be at least 1");
+	}
+	GradingJob job;
+	job.catalog = bind_data.catalog;
+	job.task = bind_data.task;
+	job.user_sql = bind_data.user_sql;
+	job.variants = bind_data.variants;
+	job.attempt_user = bind_data.attempt_user;
+	for (auto name : GRADING_SETTINGS) {
+		job.settings.emplace_back(name, DojoSetting(context, name));
+	}
+	auto max_queued = DojoSetting(context, "dojo_grading_queue_size").GetValue<uint64_t>();
+	auto ticket = DojoState::Get(context)->grading.Submit(std::move(job), max_queued, workers);
+	output.SetValue(0, 0, Value::UBIGINT(ticket));
+	output.SetCardinality(1);
+}
+
+static void GradingTicketColumns(vector<LogicalType> &return_types, vector<string> &names) {
+	return_types = {
+	    LogicalType::UBIGINT,   // ticket
+	    LogicalType::INTEGER,   // task_id
+	    LogicalType::VARCHAR,   // status: 'queued', 'running' or 'done'
+	    LogicalType::BOOLEAN,   // ok, NULL until done
+	    LogicalType::VARCHAR,   // message, NULL until done
+	    LogicalType::UBIGINT,   // expected_rows, NULL until done
+	    LogicalType::UBIGINT,   // actual_rows, NULL until done
+	    LogicalType::TIMESTAMP, // submitted_at
+	    LogicalType::TIMESTAMP, // finished_at, NULL until done
+	    LogicalType::UBIGINT    // sequence: order in which submissions finished grading, NULL until done
+	};
+	names = {"ticket",        "task_id",     "status",       "ok",          "message",
+	         "expected_rows", "actual_rows", "submitted_at", "finished_at", "sequence"};
+}
+
+static vector<Value> GradingTicketRow(idx_t ticket, const GradingTicket &entry) {
+	auto done = entry.status == GradingStatus::DONE;
+	auto &verdict = entry.verdict;
+	return {Value::UBIGINT(ticket),
+	        Value::INTEGER(entry.task_id),
+	        Value(GRADING_STATUS_NAMES[idx_t(entry.status)]),
+	        done ? Value::BOOLEAN(verdict.ok) : Value(LogicalType::BOOLEAN),
+	        done ? Value(verdict.message) : Value(LogicalType::VARCHAR),
+	        done ? Value::UBIGINT(verdict.expected_rows) : Value(LogicalType::UBIGINT),
+	        done ? Value::UBIGINT(verdict.actual_rows) : Value(LogicalType::UBIGINT),
+	        Value::TIMESTAMP(entry.submitted_at),
+	        done ? Value::TIMESTAMP(entry.finished_at) : Value(LogicalType::TIMESTAMP),
+	        done ? Value::UBIGINT(entry.sequence) : Value(LogicalType::UBIGINT)};
+}
+
+struct DojoResultData : public TableFunctionData {
+	idx_t ticket = 0;
+	bool wait = false;
+};
+
+static unique_ptr<FunctionData> DojoResultBind(ClientContext &context, TableFunctionBindInput &input,
+                                              vector<LogicalType> &return_types, vector<string> &names) {
+	(void)context;
+	if (input.inputs.size() != 1 || input.inputs[0].IsNull()) {
+		throw InvalidInputException("dojo_result requires 1 argument: ticket (UBIGINT)");
+	}
+	GradingTicketColumns(return_types, names);
+	auto bind_data = make_uniq<DojoResultData>();
+	bind_data->ticket = input.inputs[0].GetValue<uint64_t>();
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "wait") {
+			bind_data->wait = BooleanValue::Get(kv.second);
+		}
+	}
+	return std::move(bind_data);
+}
+
+static void DojoResultFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoResultData>();
+	auto &state = data_p.global_state->Cast<DojoRowsState>();
+	if (!state.computed) {
+		state.computed = true;
+		GradingTicket entry;
+		if (!DojoState::Get(context)->grading.Find(context, bind_data.ticket, bind_data.wait, entry)) {
+			throw InvalidInputException("dojo_result: unknown ticket %llu. Results are kept for the %llu most "
+			                            "recently graded submissions.",
+			                            (unsigned long long)bind_data.ticket,
+			                            (unsigned long long)GRADING_RESULT_RETENTION);
+		}
+		state.rows.push_back(GradingTicketRow(bind_data.ticket, entry));
+	}
+	EmitRows(state, output);
+}
+
+struct DojoResultsData : public TableFunctionData {
+	optional_idx after;
+};
+
+static unique_ptr<FunctionData> DojoResultsBind(ClientContext &context, TableFunctionBindInput &input,
+                                               vector<LogicalType> &return_types, vector<string> &names) {
+	(void)context;
+	GradingTicketColumns(return_types, names);
+	auto bind_data = make_uniq<DojoResultsData>();
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "after" && !kv.second.IsNull()) {
+			bind_data->after = kv.second.GetValue<uint64_t>();
+		}
+	}
+	return std::move(bind_data);
+}
+
+static void DojoResultsFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoResultsData>();
+	auto &state = data_p.global_state->Cast<DojoRowsState>();
+	if (!state.computed) {
+		state.computed = true;
+		for (auto &ticket : DojoState::Get(context)->grading.Tickets(bind_data.after)) {
+			state.rows.push_back(GradingTicketRow(ticket.first, ticket.second));
+		}
+	}
+	EmitRows(state, output);
+}
+
+// -------------------------- dojo_profile (table function) --------------------------
+
+struct DojoProfileRow {
+	std::string side;
+	idx_t operator_id = 0;
+	idx_t depth = 0;
+	std::string operator_type;
+	Value estimated_cardinality;
+	idx_t actual_cardinality = 0;
+	double time_ms = 0;
+	double time_share = 0;
+};
+
+struct DojoProfileState : public GlobalTableFunctionState {
+	bool computed = false;
+	std::vector<DojoProfileRow> rows;
+	idx_t offset = 0;
+};
+
+static unique_ptr<GlobalTableFunctionState> DojoProfileInit(ClientContext &context, TableFunctionInitInput &input) {
+	(void)context;
+	(void)input;
+	return make_uniq<DojoProfileState>();
+}
+
+static unique_ptr<FunctionData> DojoProfileBind(ClientContext &context, TableFunctionBindInput &input,
+                                               vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 2) {
+		throw InvalidInputException("dojo_profile requires 2 arguments: task_id (INTEGER), user_sql (VARCHAR)");
+	}
+
+	return_types = {
+	    LogicalType::VARCHAR, // side: 'user' or 'expected'
+	    LogicalType::UBIGINT, // operator_id, pre-order within the side
+	    LogicalType::UBIGINT, // depth
+	    LogicalType::VARCHAR, // operator_type
+	    LogicalType::UBIGINT, // estimated_cardinality
+	    LogicalType::UBIGINT, // actual_cardinality
+	    LogicalType::DOUBLE,  // time_ms
+	    LogicalType::DOUBLE   // time_share of the side's total operator time
+	};
+	names = {"side",          "operator_id",        "depth",   "operator_type",
+	         "estimated_cardinality", "actual_cardinality", "time_ms", "time_share"};
+
+	auto state = make_uniq<DojoCheckState>();
+	BindTask(context, input.inputs[0].GetValue<int32_t>(), *state);
+	state->user_sql = input.inputs[1].ToString();
+	return std::move(state);
+}
+
+// Flattens the profiler tree of one query into pre-order rows.
+static void CollectOperators(const ProfilingNode &node, const std::string &side, idx_t depth,
+                             std::vector<DojoProfileRow> &rows) {
+	auto &info = node.GetProfilingInfo();
+	DojoProfileRow row;
+	row.side = side;
+	row.depth = depth;
+	auto type = info.metrics.find(MetricsType::OPERATOR_TYPE);
+	if (type != info.metrics.end() && !type->second.IsNull()) {
+		row.operator_type = type->second.type().id() == LogicalTypeId::VARCHAR
+		                        ? type->second.ToString()
+		                        : PhysicalOperatorToString(PhysicalOperatorType(type->second.GetValue<uint8_t>()));
+	}
+	auto estimate = info.extra_info.find("Estimated Cardinality");
+	if (estimate != info.extra_info.end()) {
+		Value cardinality(StringUtil::Replace(estimate->second, "~", ""));
+		if (cardinality.DefaultTryCastAs(LogicalType::UBIGINT)) {
+			row.estimated_cardinality = cardinality;
+		}
+	}
+	row.actual_cardinality = ProfilerCount(info, MetricsType::OPERATOR_CARDINALITY);
+	auto timing = info.metrics.find(MetricsType::OPERATOR_TIMING);
+	if (timing != info.metrics.end() && !timing->second.IsNull()) {
+		row.time_ms = timing->second.GetValue<double>() * 1000.0;
+	}
+	rows.push_back(std::move(row));
+	for (idx_t i = 0; i < node.GetChildCount(); i++) {
+		CollectOperators(*node.GetChild(i), side, depth + 1, rows);
+	}
+}
+
+// Runs one query to completion on a profiled connection and appends its operators.
+static void ProfileQuery(Connection &con, const std::string &sql, const std::string &side,
+                         std::vector<DojoProfileRow> &rows) {
+	// Only the profile is of interest, so the result is not kept
+	std::string err;
+	if (!DrainQuery(con, sql, err)) {
+		throw InvalidInputException("The %s query failed to run: %s", side, err);
+	}
+	auto root = QueryProfiler::Get(*con.context).GetRoot();
+	if (!root) {
+		return;
+	}
+	auto first = rows.size();
+	// The root node stands for the query itself; its children are the physical operators
+	for (idx_t i = 0; i < root->GetChildCount(); i++) {
+		CollectOperators(*root->GetChild(i), side, 0, rows);
+	}
+	double total_ms = 0;
+	for (auto i = first; i < rows.size(); i++) {
+		total_ms += rows[i].time_ms;
+	}
+	for (auto i = first; i < rows.size(); i++) {
+		rows[i].operator_id = i - first;
+		rows[i].time_share = total_ms > 0 ? rows[i].time_ms / total_ms : 0;
+	}
+}
+
+static void DojoProfileFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoCheckState>();
+	auto &state = data_p.global_state->Cast<DojoProfileState>();
+	if (!state.computed) {
+		state.computed = true;
+		auto &task = bind_data.task;
+		std::string err;
+		if (!ValidateSubmission(bind_data.user_sql, err)) {
+			throw InvalidInputException("Your query failed to run: %s", err);
+		}
+
+		auto env = CheckEnv::Capture(context);
+		auto dojo = env.dojo;
+		PooledConnection check(env, true);
+		auto &con = check.Con();
+		auto limits = DojoCheckLimits::Resolve(env, *task);
+		DatasetLease lease;
+		UseDucklings(check.Get(), LeaseCheckDataset(*dojo, check, lease));
+		EnableProfiling(check.Get());
+
+		WatchGuard watch(check.Dojo().watchdog, *con.context, env, limits);
+		try {
+			ProfileQuery(con, bind_data.user_sql, "user", state.rows);
+			ProfileQuery(con, task->expected_sql, "expected", state.rows);
+		} catch (std::exception &) {
+			if (watch.Reason() != CheckAbortReason::NONE) {
+				throw InvalidInputException(AbortMessage(watch.Reason(), limits));
+			}
+			throw;
+		}
+	}
+
+	idx_t count = 0;
+	while (state.offset < state.rows.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &row = state.rows[state.offset];
+		output.SetValue(0, count, Value(row.side));
+		output.SetValue(1, count, Value::UBIGINT(row.operator_id));
+		output.SetValue(2, count, Value::UBIGINT(row.depth));
+		output.SetValue(3, count, Value(row.operator_type));
+		output.SetValue(4, count, row.estimated_cardinality);
+		output.SetValue(5, count, Value::UBIGINT(row.actual_cardinality));
+		output.SetValue(6, count, Value::DOUBLE(row.time_ms));
+		output.SetValue(7, count, Value::DOUBLE(row.time_share));
+		state.offset++;
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+// -------------------------- dojo_diff (table function) --------------------------
+
+// The text of the single statement in sql without its trailing semicolon, so it can be embedded as a subquery.
+static std::string StatementText(const std::string &sql) {
+	Parser parser;
+	parser.ParseQuery(sql);
+	auto &statement = *parser.statements[0];
+	return sql.substr(statement.stmt_location, statement.stmt_length);
+}
+
+// Temp tables of the inner connection that hold both results of an ordered diff, with their positions
+static constexpr const char *DIFF_EXPECTED_TABLE = "dojo_diff_expected";
+static constexpr const char *DIFF_ACTUAL_TABLE = "dojo_diff_actual";
+
+static std::string DiffColumns(idx_t count) {
+	std::string cols;
+	for (idx_t c = 0; c < count; c++) {
+		cols += (c == 0 ? "c" : ", c") + std::to_string(c);
+	}
+	return cols;
+}
+
+// Runs sql and stores its rows, renamed to c0..cN, in the temp table with a 1-based pos column numbering them in the
+// order they were fetched. Positions cannot come from the diff query itself: a window over a subquery is not bound to
+// keep the subquery's ORDER BY. The result is buffered in a buffer-managed collection first, since the connection
+// cannot append while it streams a result.
+static void StageOrderedRows(Connection &con, const std::string &sql, idx_t column_count, const std::string &table,
+                             const char *query_name) {
+	std::string err;
+	auto create = StringUtil::Format("CREATE OR REPLACE TEMP TABLE %s AS SELECT *, NULL::UBIGINT AS pos FROM (\n%s\n) "
+	                                 "AS t(%s) LIMIT 0",
+	                                 table, StatementText(sql), DiffColumns(column_count));
+	if (!SafeQuery(con, create, err)) {
+		throw InvalidInputException("%s failed to run: %s", query_name, err);
+	}
+	auto rows = BufferQuery(con, sql, err);
+	if (!rows) {
+		throw InvalidInputException("%s failed to run: %s", query_name, err);
+	}
+	auto types = rows->Types();
+	types.push_back(LogicalType::UBIGINT);
+	DataChunk staged;
+	staged.Initialize(Allocator::DefaultAllocator(), types);
+	Appender appender(con, TEMP_CATALOG, DEFAULT_SCHEMA, table);
+	idx_t pos = 0;
+	for (auto &chunk : rows->Chunks()) {
+		staged.Reset();
+		for (idx_t c = 0; c < chunk.ColumnCount(); c++) {
+			staged.data[c].Reference(chunk.data[c]);
 		}
-		auto row_count = chunk->size();
-		auto col_count = chunk->ColumnCount();
-		for (idx_t r = 0; r < row_count; r++) {
-			std::vector<std::string> row;
-			row.reserve(col_count);
-			for (idx_t c = 0; c < col_count; c++) {
-				row.push_back(chunk->GetValue(c, r).ToString());
-			}
-			out.rows.push_back(std::move(row));
+		auto positions = FlatVector::GetData<uint64_t>(staged.data[column_count]);
+		for (idx_t i = 0; i < chunk.size(); i++) {
+			positions[i] = ++pos;
 		}
+		staged.SetCardinality(chunk.size());
+		appender.AppendDataChunk(staged);
 	}
-	return out;
+	appender.Close();
 }
 
-static std::string JoinRow(const std::vector<std::string> &row) {
-	// Unit Separator for low collision risk
-	const char sep = 0x1f;
-	std::string s;
-	for (idx_t i = 0; i < row.size(); i++) {
-		if (i) s.push_back(sep);
-		s += row[i];
+// Builds the row-level diff of the canonical and the user's result as one query, so the hash aggregates, joins and
+// sorts of the inner connection do the work and spill to disk for large results. Both sides are renamed to c0..cN by
+// position; columns whose types differ are compared as VARCHAR, like dojo_check does.
+//
+// Unordered levels diff the two multisets. Ordered levels pair the k-th occurrence of a row in one result with the
+// k-th occurrence in the other: unpaired rows are missing or extra, paired rows at different positions are out of
+// position. Their rows and positions are read from the tables StageOrderedRows() filled.
+static std::string DiffSQL(const std::string &expected_sql, const std::string &user_sql,
+                           const vector<LogicalType> &expected_types, const vector<LogicalType> &actual_types,
+                           bool ordered) {
+	std::string cols, expected_select, actual_select, pick, join;
+	for (idx_t c = 0; c < expected_types.size(); c++) {
+		auto col = "c" + std::to_string(c);
+		auto sep = c == 0 ? "" : ", ";
+		cols += sep + col;
+		auto same_type = expected_types[c] == actual_types[c];
+		expected_select += sep + (same_type ? col : col + "::VARCHAR AS " + col);
+		actual_select += sep + (same_type ? col : col + "::VARCHAR AS " + col);
+		pick += StringUtil::Format("%sCASE WHEN eo.pos IS NULL THEN ao.%s ELSE eo.%s END AS %s", sep, col, col, col);
+		join += StringUtil::Format("eo.%s IS NOT DISTINCT FROM ao.%s AND ", col, col);
 	}
-	return s;
+	// CTE names are prefixed, since both queries are embedded in their scope
+	if (!ordered) {
+		auto expected_from = StringUtil::Format("FROM (\n%s\n) AS t(%s)", StatementText(expected_sql), cols);
+		auto actual_from = StringUtil::Format("FROM (\n%s\n) AS t(%s)", StatementText(user_sql), cols);
+		return StringUtil::Format(
+		    "WITH dojo_union AS (SELECT %s, 1 AS e_n, 0 AS a_n %s UNION ALL SELECT %s, 0 AS e_n, 1 AS a_n %s), "
+		    "dojo_groups AS (SELECT %s, SUM(e_n) AS e_count, SUM(a_n) AS a_count FROM dojo_union GROUP BY %s) "
+		    "SELECT CASE WHEN e_count > a_count THEN 'missing' ELSE 'extra' END AS kind, %s, "
+		    "ABS(e_count - a_count)::UBIGINT AS multiplicity, NULL::UBIGINT AS expected_position, "
+		    "NULL::UBIGINT AS actual_position FROM dojo_groups WHERE e_count <> a_count "
+		    "ORDER BY kind, multiplicity DESC",
+		    expected_select, expected_from, actual_select, actual_from, cols, cols, cols);
+	}
+	return StringUtil::Format(
+	    "WITH dojo_expected AS (SELECT %s, pos FROM temp.main.%s), "
+	    "dojo_actual AS (SELECT %s, pos FROM temp.main.%s), "
+	    "dojo_expected_occ AS (SELECT *, ROW_NUMBER() OVER (PARTITION BY %s ORDER BY pos) AS occ FROM dojo_expected), "
+	    "dojo_actual_occ AS (SELECT *, ROW_NUMBER() OVER (PARTITION BY %s ORDER BY pos) AS occ FROM dojo_actual), "
+	    "dojo_diff AS (SELECT CASE WHEN ao.pos IS NULL THEN 'missing' WHEN eo.pos IS NULL THEN 'extra' "
+	    "ELSE 'out_of_position' END AS kind, %s, eo.pos AS expected_position, ao.pos AS actual_position "
+	    "FROM dojo_expected_occ eo FULL OUTER JOIN dojo_actual_occ ao ON %seo.occ = ao.occ "
+	    "WHERE eo.pos IS DISTINCT FROM ao.pos) "
+	    "SELECT * FROM (SELECT kind, %s, COUNT(*)::UBIGINT AS multiplicity, "
+	    "MIN(expected_position)::UBIGINT AS expected_position, MIN(actual_position)::UBIGINT AS actual_position "
+	    "FROM dojo_diff WHERE kind <> 'out_of_position' GROUP BY kind, %s "
+	    "UNION ALL SELECT kind, %s, 1::UBIGINT, expected_position::UBIGINT, actual_position::UBIGINT FROM dojo_diff "
+	    "WHERE kind = 'out_of_position') ORDER BY COALESCE(expected_position, actual_position), kind",
+	    expected_select, DIFF_EXPECTED_TABLE, actual_select, DIFF_ACTUAL_TABLE, cols, cols, pick, join, cols, cols,
+	    cols);
 }
 
-static std::vector<std::string> NormalizeColNames(const std::vector<std::string> &cols) {
-	std::vector<std::string> out;
-	out.reserve(cols.size());
-	for (auto &c : cols) {
-		out.push_back(StringUtil::Lower(c));
+struct DojoDiffState : public GlobalTableFunctionState {
+	~DojoDiffState() override {
+		result.reset();
+		if (staged && check) {
+			// The pooled connection is reused, so the staged rows do not outlive the diff
+			auto &con = check->Con();
+			con.context->interrupted = false;
+			std::string err;
+			SafeQuery(con,
+			          StringUtil::Format("DROP TABLE IF EXISTS temp.main.%s; DROP TABLE IF EXISTS temp.main.%s",
+			                             DIFF_EXPECTED_TABLE, DIFF_ACTUAL_TABLE),
+			          err);
+		}
 	}
-	return out;
+
+	bool started = false;
+	//! Whether the results of an ordered diff were staged in temp tables
+	bool staged = false;
+	DojoCheckLimits limits;
+	std::vector<std::string> col_names;
+	// Declared in teardown order: the result is closed before the watch ends, the dataset lease is dropped and the
+	// connection goes back
+	unique_ptr<PooledConnection> check;
+	DatasetLease lease;
+	unique_ptr<WatchGuard> watch;
+	unique_ptr<QueryResult> result;
+};
+
+static unique_ptr<GlobalTableFunctionState> DojoDiffInit(ClientContext &context, TableFunctionInitInput &input) {
+	(void)context;
+	(void)input;
+	return make_uniq<DojoDiffState>();
 }
 
-static bool EqualCols(const std::vector<std::string> &a, const std::vector<std::string> &b) {
-	if (a.size() != b.size()) return false;
-	for (idx_t i = 0; i < a.size(); i++) {
-		if (StringUtil::Lower(a[i]) != StringUtil::Lower(b[i])) return false;
+static unique_ptr<FunctionData> DojoDiffBind(ClientContext &context, TableFunctionBindInput &input,
+                                            vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 2) {
+		throw InvalidInputException("dojo_diff requires 2 arguments: task_id (INTEGER), user_sql (VARCHAR)");
 	}
-	return true;
+
+	return_types = {
+	    LogicalType::VARCHAR, // kind: 'missing', 'extra' or 'out_of_position'
+	    LogicalType::VARCHAR, // row, with the expected column names
+	    LogicalType::UBIGINT, // multiplicity
+	    LogicalType::UBIGINT, // expected_position (1-based, ordered levels only)
+	    LogicalType::UBIGINT  // actual_position (1-based, ordered levels only)
+	};
+	names = {"kind", "row", "multiplicity", "expected_position", "actual_position"};
+
+	auto state = make_uniq<DojoCheckState>();
+	BindTask(context, input.inputs[0].GetValue<int32_t>(), *state);
+	state->user_sql = input.inputs[1].ToString();
+	return std::move(state);
 }
 
-static std::string ColList(const std::vector<std::string> &cols) {
-	std::ostringstream ss;
-	for (idx_t i = 0; i < cols.size(); i++) {
-		if (i) ss << ", ";
-		ss << cols[i];
+// Starts the diff query on a pooled connection; its result is streamed out by DojoDiffFunc.
+static void StartDiff(ClientContext &context, const DojoCheckState &bind_data, DojoDiffState &state) {
+	auto &task = *bind_data.task;
+	std::string err;
+	if (!ValidateSubmission(bind_data.user_sql, err)) {
+		throw InvalidInputException("Your query failed to run: %s", err);
 	}
-	return ss.str();
-}
 
-static unique_ptr<QueryResult> SafeQuery(Connection &con, const std::string &sql, std::string &err) {
-	auto res = con.Query(sql);
-	if (!res) {
-		err = "Unknown error executing query.";
-		return nullptr;
+	auto env = CheckEnv::Capture(context);
+	auto dojo = env.dojo;
+	state.check = make_uniq<PooledConnection>(env, true);
+	auto &con = state.check->Con();
+	state.limits = DojoCheckLimits::Resolve(env, task);
+	UseDucklings(state.check->Get(), LeaseCheckDataset(*dojo, *state.check, state.lease));
+
+	auto expected = con.Prepare(task.expected_sql);
+	if (expected->HasError()) {
+		throw InvalidInputException("The expected query failed to run: %s", expected->GetError());
 	}
-	if (res->HasError()) {
-		err = res->GetError();
-		return nullptr;
+	auto actual = con.Prepare(bind_data.user_sql);
+	if (actual->HasError()) {
+		throw InvalidInputException("Your query failed to run: %s", actual->GetError());
 	}
-	return res;
-}
+	if (expected->GetTypes().size() != actual->GetTypes().size()) {
+		throw InvalidInputException("Column mismatch. Expected columns: [%s], got: [%s].",
+		                            ColList(task.expected_columns), ColList(actual->GetNames()));
+	}
+	state.col_names = expected->GetNames();
+	auto sql = DiffSQL(task.expected_sql, bind_data.user_sql, expected->GetTypes(), actual->GetTypes(),
+	                   task.requires_order);
 
-static void EnsureDucklings(Connection &con) {
-	// We reset the TEMP ducklings table on every check to ensure deterministic tasks.
-	std::string err;
-	auto res = SafeQuery(con, DucklingsSetupSQL(), err);
-	if (!res) {
-		// If setup fails, let the calling code return a message. Throwing here simplifies flow.
-		throw InvalidInputException("Failed to initialize ducklings dataset: %s", err);
+	state.watch = make_uniq<WatchGuard>(state.check->Dojo().watchdog, *con.context, env, state.limits);
+	if (task.requires_order) {
+		state.staged = true;
+		try {
+			StageOrderedRows(con, task.expected_sql, state.col_names.size(), DIFF_EXPECTED_TABLE, "The expected query");
+			StageOrderedRows(con, bind_data.user_sql, state.col_names.size(), DIFF_ACTUAL_TABLE, "Your query");
+		} catch (std::exception &) {
+			if (state.watch->Reason() != CheckAbortReason::NONE) {
+				throw InvalidInputException(AbortMessage(state.watch->Reason(), state.limits));
+			}
+			throw;
+		}
+	}
+	state.result = con.SendQuery(sql);
+	if (state.result->HasError()) {
+		if (state.watch->Reason() != CheckAbortReason::NONE) {
+			throw InvalidInputException(AbortMessage(state.watch->Reason(), state.limits));
+		}
+		throw InvalidInputException("Failed to diff the results: %s", state.result->GetError());
 	}
 }
 
-static std::string CompareResults(const DojoTask &task, const MaterializedRows &expected,
-                                  const MaterializedRows &actual, bool &ok_out) {
-	// Column shape checks
-	if (!EqualCols(actual.col_names, task.expected_columns)) {
-		ok_out = false;
-		std::ostringstream ss;
-		ss << "Column mismatch. Expected columns: [" << ColList(task.expected_columns) << "], got: ["
-		   << ColList(actual.col_names) << "].";
-		ss << " Tip: use aliases (AS ...) to match expected column names.";
-		return ss.str();
+static void DojoDiffFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoCheckState>();
+	auto &state = data_p.global_state->Cast<DojoDiffState>();
+	if (!state.started) {
+		state.started = true;
+		StartDiff(context, bind_data, state);
 	}
-	if (task.max_rows >= 0 && (int32_t)actual.rows.size() > task.max_rows) {
-		ok_out = false;
-		std::ostringstream ss;
-		ss << "Too many rows. This level expects at most " << task.max_rows << " row(s), but your query returned "
-		   << actual.rows.size() << ".";
-		ss << " Tip: use LIMIT " << task.max_rows << ".";
-		return ss.str();
+	if (!state.result) {
+		output.SetCardinality(0);
+		return;
 	}
 
-	// Prepare comparisons
-	if (expected.rows.size() != actual.rows.size()) {
-		ok_out = false;
-		std::ostringstream ss;
-		ss << "Row count mismatch. Expected " << expected.rows.size() << " row(s), got " << actual.rows.size() << ".";
-		ss << " Tip: check your WHERE / GROUP BY / LIMIT logic.";
-		return ss.str();
+	unique_ptr<DataChunk> chunk;
+	std::string err;
+	if (!FetchChunk(*state.result, chunk, err)) {
+		if (state.watch->Reason() != CheckAbortReason::NONE) {
+			throw InvalidInputException(AbortMessage(state.watch->Reason(), state.limits));
+		}
+		throw InvalidInputException("Failed to diff the results: %s", err);
 	}
-
-	auto exp_joined = std::vector<std::string>();
-	auto act_joined = std::vector<std::string>();
-	exp_joined.reserve(expected.rows.size());
-	act_joined.reserve(actual.rows.size());
-	for (auto &r : expected.rows) exp_joined.push_back(JoinRow(r));
-	for (auto &r : actual.rows) act_joined.push_back(JoinRow(r));
-
-	if (!task.requires_order) {
-		std::sort(exp_joined.begin(), exp_joined.end());
-		std::sort(act_joined.begin(), act_joined.end());
+	if (!chunk || chunk->size() == 0) {
+		state.result.reset();
+		output.SetCardinality(0);
+		return;
 	}
-
-	for (idx_t i = 0; i < exp_joined.size(); i++) {
-		if (exp_joined[i] != act_joined[i]) {
-			ok_out = false;
-			std::ostringstream ss;
-			ss << "Result mismatch. Your output does not match the expected result.";
-			if (task.requires_order) {
-				ss << " This level checks ordering, so make sure to include the ORDER BY from the goal.";
-			} else {
-				ss << " Note: this level does not require ordering.";
-			}
-			ss << " First difference at row " << (i + 1) << ".";
-			return ss.str();
+	// Diff rows are (kind, c0..cN, multiplicity, expected_position, actual_position)
+	auto col_count = state.col_names.size();
+	for (idx_t row = 0; row < chunk->size(); row++) {
+		child_list_t<Value> values;
+		for (idx_t c = 0; c < col_count; c++) {
+			values.emplace_back(state.col_names[c], chunk->GetValue(1 + c, row));
 		}
+		output.SetValue(0, row, chunk->GetValue(0, row));
+		output.SetValue(1, row, Value(Value::STRUCT(std::move(values)).ToString()));
+		output.SetValue(2, row, chunk->GetValue(1 + col_count, row));
+		output.SetValue(3, row, chunk->GetValue(2 + col_count, row));
+		output.SetValue(4, row, chunk->GetValue(3 + col_count, row));
 	}
-
-	ok_out = true;
-	return "✅ Nice work, your query matches the expected output for this level.";
+	output.SetCardinality(chunk->size());
 }
 
+// -------------------------- dojo_cache_stats (table function) --------------------------
 
-// -------------------------- dojo_setup (table function) --------------------------
-
-struct DojoSetupBindData : public TableFunctionData {
-	bool done = false;
-};
-
-static unique_ptr<FunctionData> DojoSetupBind(ClientContext &context, TableFunctionBindInput &input,
-                                             vector<LogicalType> &return_types, vector<string> &names) {
+static unique_ptr<FunctionData> DojoCacheStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
 	(void)context;
 	(void)input;
-	return_types.clear();
-	names.clear();
-	return_types.push_back(LogicalType::VARCHAR);
-	names.push_back("message");
-	return make_uniq<DojoSetupBindData>();
+	return_types = {
+	    LogicalType::UBIGINT, // entries
+	    LogicalType::UBIGINT, // hits
+	    LogicalType::UBIGINT  // misses
+	};
+	names = {"entries", "hits", "misses"};
+	return make_uniq<TableFunctionData>();
 }
 
-static void DojoSetupFunc(ClientContext &context, TableFunctionInput &input, DataChunk &output) {
-	auto &bind = input.bind_data->Cast<DojoSetupBindData>();
-	if (bind.done) {
+static void DojoCacheStatsFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &gstate = data_p.global_state->Cast<DojoSingleRowState>();
+	if (gstate.done) {
 		output.SetCardinality(0);
 		return;
 	}
+	gstate.done = true;
 
-	bind.done = true;
+	auto dojo = DojoState::Get(context);
+	auto &cache = dojo->expected_cache;
+	output.SetValue(0, 0, Value::UBIGINT(cache.EntryCount()));
+	output.SetValue(1, 0, Value::UBIGINT(cache.hits.load()));
+	output.SetValue(2, 0, Value::UBIGINT(cache.misses.load()));
 	output.SetCardinality(1);
-
-	string message;
-	try {
-		Connection con(*context.db);
-		string err;
-		auto res = SafeQuery(con, DucklingsSetupSQL(), err);
-		if (!res) {
-			message = "Failed to create ducklings dataset: " + err;
-		} else {
-			message = "Ducklings dataset loaded as TEMP table 'ducklings' (name, color, age).";
-		}
-	} catch (std::exception &ex) {
-		message = std::string("Internal exception: ") + ex.what();
-	}
-
-	output.SetValue(0, 0, Value(message));
 }
 
-// -------------------------- dojo_tasks (table function) --------------------------
-
-struct DojoTasksState : public FunctionData {
-	idx_t offset = 0;
-};
+// -------------------------- dojo_stats / dojo_stats_reset (table functions) --------------------------
 
-static unique_ptr<FunctionData> DojoTasksBind(ClientContext &context, TableFunctionBindInput &input,
+static unique_ptr<FunctionData> DojoStatsBind(ClientContext &context, TableFunctionBindInput &input,
                                              vector<LogicalType> &return_types, vector<string> &names) {
 	(void)context;
 	(void)input;
 	return_types = {
-	    LogicalType::INTEGER, // task_id
-	    LogicalType::INTEGER, // level
-	    LogicalType::VARCHAR, // title
-	    LogicalType::VARCHAR, // topic
-	    LogicalType::INTEGER, // difficulty
-	    LogicalType::VARCHAR, // goal
-	    LogicalType::VARCHAR, // badge
-	    LogicalType::BOOLEAN, // requires_order
-	    LogicalType::INTEGER, // max_rows
-	    LogicalType::LIST(LogicalType::VARCHAR) // expected_columns
-	};
-	names = {
-	    "task_id",
-	    "level",
-	    "title",
-	    "topic",
-	    "difficulty",
-	    "goal",
-	    "badge",
-	    "requires_order",
-	    "max_rows",
-	    "expected_columns"
+	    LogicalType::INTEGER, // task_id, NULL for all tasks
+	    LogicalType::VARCHAR, // metric: a phase (latency) or a counter
+	    LogicalType::UBIGINT, // count: checks that reached the phase, or the counter's value
+	    LogicalType::DOUBLE,  // p50_ms, NULL for counters
+	    LogicalType::DOUBLE,  // p95_ms
+	    LogicalType::DOUBLE   // p99_ms
 	};
-	return make_uniq<DojoTasksState>();
+	names = {"task_id", "metric", "count", "p50_ms", "p95_ms", "p99_ms"};
+	return make_uniq<TableFunctionData>();
 }
 
-static void DojoTasksFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-	(void)context;
-	auto &state = data_p.bind_data->Cast<DojoTasksState>();
-	auto &tasks = GetTasks();
-
-	idx_t row = 0;
-	while (state.offset < tasks.size() && row < STANDARD_VECTOR_SIZE) {
-		auto &t = tasks[state.offset];
-
-		output.SetValue(0, row, Value::INTEGER(t.task_id));
-		output.SetValue(1, row, Value::INTEGER(t.level));
-		output.SetValue(2, row, Value(t.title));
-		output.SetValue(3, row, Value(t.topic));
-		output.SetValue(4, row, Value::INTEGER(t.difficulty));
-		output.SetValue(5, row, Value(t.goal));
-		output.SetValue(6, row, Value(t.badge));
-		output.SetValue(7, row, Value::BOOLEAN(t.requires_order));
-		output.SetValue(8, row, Value::INTEGER(t.max_rows));
-
-		std::vector<Value> col_vals;
-		col_vals.reserve(t.expected_columns.size());
-		for (auto &c : t.expected_columns) {
-			col_vals.push_back(Value(c));
-		}
-		output.SetValue(9, row, Value::LIST(LogicalType::VARCHAR, col_vals));
-
-		state.offset++;
-		row++;
+static Value HistogramPercentile(const vector<uint64_t> &buckets, uint64_t count, double fraction) {
+	if (count == 0) {
+		return Value(LogicalType::DOUBLE);
+	}
+	auto rank = MaxValue<uint64_t>(uint64_t(std::ceil(fraction * double(count))), 1);
+	uint64_t seen = 0;
+	for (idx_t bucket = 0; bucket < buckets.size(); bucket++) {
+		seen += buckets[bucket];
+		if (seen >= rank) {
+			return Value::DOUBLE(HistogramBucketMs(bucket));
+		}
 	}
-	output.SetCardinality(row);
+	return Value::DOUBLE(HistogramBucketMs(buckets.size() - 1));
 }
 
-// -------------------------- dojo_hint (scalar) --------------------------
+static void AddStatsRows(const Value &task_id, const CheckStatsSnapshot &snapshot, vector<vector<Value>> &rows) {
+	for (idx_t phase = 0; phase < CHECK_PHASE_COUNT; phase++) {
+		auto &buckets = snapshot.phases[phase];
+		uint64_t count = 0;
+		for (auto bucket : buckets) {
+			count += bucket;
+		}
+		rows.push_back({task_id, Value(CHECK_PHASE_NAMES[phase]), Value::UBIGINT(count),
+		                HistogramPercentile(buckets, count, 0.5), HistogramPercentile(buckets, count, 0.95),
+		                HistogramPercentile(buckets, count, 0.99)});
+	}
+	for (idx_t counter = 0; counter < CHECK_COUNTER_COUNT; counter++) {
+		rows.push_back({task_id, Value(CHECK_COUNTER_NAMES[counter]), Value::UBIGINT(snapshot.counters[counter]),
+		                Value(LogicalType::DOUBLE), Value(LogicalType::DOUBLE), Value(LogicalType::DOUBLE)});
+	}
+}
 
-static void DojoHintFunc(DataChunk &args, ExpressionState &state, Vector &result) {
-	(void)state;
+static void DojoStatsFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.global_state->Cast<DojoRowsState>();
+	if (!state.computed) {
+		state.computed = true;
+		auto &stats = DojoState::Get(context)->stats;
+		AddStatsRows(Value(LogicalType::INTEGER), stats.Totals(), state.rows);
+		for (auto &task : stats.Tasks()) {
+			AddStatsRows(Value::INTEGER(task.first), task.second, state.rows);
+		}
+	}
+	EmitRows(state, output);
+}
 
-	result.SetVectorType(VectorType::FLAT_VECTOR);
-	auto result_data = FlatVector::GetData<string_t>(result);
+static unique_ptr<FunctionData> DojoStatsResetBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+	(void)context;
+	(void)input;
+	return_types = {LogicalType::VARCHAR};
+	names = {"message"};
+	return make_uniq<TableFunctionData>();
+}
 
-	auto &task_id_vec = args.data[0];
-	auto &hint_level_vec = args.data[1];
+static void DojoStatsResetFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &gstate = data_p.global_state->Cast<DojoSingleRowState>();
+	if (gstate.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	gstate.done = true;
 
-	UnifiedVectorFormat task_id_data;
-	UnifiedVectorFormat hint_level_data;
-	task_id_vec.ToUnifiedFormat(args.size(), task_id_data);
-	hint_level_vec.ToUnifiedFormat(args.size(), hint_level_data);
+	DojoState::Get(context)->stats.Reset();
+	output.SetValue(0, 0, Value("Check statistics were reset."));
+	output.SetCardinality(1);
+}
 
-	for (idx_t i = 0; i < args.size(); i++) {
-		auto task_idx = task_id_data.sel->get_index(i);
-		auto hint_idx = hint_level_data.sel->get_index(i);
+// -------------------------- dojo_load_tasks (table function) --------------------------
 
-		if (!task_id_data.validity.RowIsValid(task_idx) || !hint_level_data.validity.RowIsValid(hint_idx)) {
-			result_data[i] = StringVector::AddString(result, "NULL input is not allowed.");
-			continue;
-		}
+// Task packs use the spec/tasks.json layout: a JSON array of task objects. timeout_ms is an optional per-task budget.
+static std::string TaskPackSQL(const std::string &glob) {
+	return StringUtil::Format(
+	    "SELECT task_id, level, title, topic, difficulty, goal, badge, requires_order, max_rows, expected_columns, "
+	    "expected_sql, hints, timeout_ms FROM read_json(%s, format = 'array', columns = {task_id: "
+	    "'INTEGER', level: 'INTEGER', title: 'VARCHAR', topic: 'VARCHAR', difficulty: 'INTEGER', goal: 'VARCHAR', "
+	    "badge: 'VARCHAR', requires_order: 'BOOLEAN', max_rows: 'INTEGER', expected_columns: 'VARCHAR[]', "
+	    "expected_sql: 'VARCHAR', hints: 'VARCHAR[]', timeout_ms: 'BIGINT'})",
+	    Value(glob).ToSQLString());
+}
 
-		auto task_id = ((int32_t *)task_id_data.data)[task_idx];
-		auto hint_level = ((int32_t *)hint_level_data.data)[hint_idx];
+static std::vector<std::string> StringList(const Value &value) {
+	std::vector<std::string> result;
+	if (value.IsNull()) {
+		return result;
+	}
+	for (auto &child : ListValue::GetChildren(value)) {
+		result.push_back(child.IsNull() ? std::string() : child.ToString());
+	}
+	return result;
+}
 
-		auto task = FindTask(task_id);
-		if (!task) {
-			result_data[i] = StringVector::AddString(result, "Unknown task_id. Try: SELECT * FROM dojo_tasks();");
-			continue;
+static std::vector<DojoTask> ReadTaskPacks(Connection &con, const std::string &glob) {
+	std::string err;
+	auto res = SafeQuery(con, TaskPackSQL(glob), err);
+	if (!res) {
+		throw InvalidInputException("Failed to read task packs from '%s': %s", glob, err);
+	}
+	std::vector<DojoTask> tasks;
+	auto &collection = res->Cast<MaterializedQueryResult>().Collection();
+	for (auto &row : collection.Rows()) {
+		if (row.GetValue(0).IsNull() || row.GetValue(2).IsNull() || row.GetValue(10).IsNull()) {
+			throw InvalidInputException("Task pack '%s': every task needs task_id, title and expected_sql", glob);
 		}
-		if (hint_level < 1) {
-			result_data[i] = StringVector::AddString(result, "Hint levels start at 1.");
-			continue;
+		DojoTask task;
+		task.task_id = row.GetValue(0).GetValue<int32_t>();
+		task.level = row.GetValue(1).IsNull() ? task.task_id : row.GetValue(1).GetValue<int32_t>();
+		task.title = row.GetValue(2).ToString();
+		task.topic = row.GetValue(3).IsNull() ? std::string() : row.GetValue(3).ToString();
+		task.difficulty = row.GetValue(4).IsNull() ? 1 : row.GetValue(4).GetValue<int32_t>();
+		task.goal = row.GetValue(5).IsNull() ? std::string() : row.GetValue(5).ToString();
+		task.badge = row.GetValue(6).IsNull() ? std::string() : row.GetValue(6).ToString();
+		task.requires_order = !row.GetValue(7).IsNull() && row.GetValue(7).GetValue<bool>();
+		task.max_rows = row.GetValue(8).IsNull() ? -1 : row.GetValue(8).GetValue<int32_t>();
+		task.expected_columns = StringList(row.GetValue(9));
+		task.expected_sql = row.GetValue(10).ToString();
+		task.hints = StringList(row.GetValue(11));
+		if (!row.GetValue(12).IsNull()) {
+			task.timeout_ms = row.GetValue(12).GetValue<int64_t>();
 		}
-		if ((idx_t)hint_level > task->hints.size()) {
-			std::ostringstream ss;
-			ss << "No more hints. This level has " << task->hints.size() << " hint(s).";
-			result_data[i] = StringVector::AddString(result, ss.str());
-			continue;
+		if (task.expected_columns.empty()) {
+			throw InvalidInputException("Task pack '%s': task %d has no expected_columns", glob, task.task_id);
 		}
-
-		result_data[i] = StringVector::AddString(result, task->hints[(idx_t)hint_level - 1]);
+		tasks.push_back(std::move(task));
 	}
-
-	FlatVector::SetNull(result, false);
+	return tasks;
 }
 
-// -------------------------- dojo_check (table function) --------------------------
-
-struct DojoCheckState : public FunctionData {
-	int32_t task_id;
-	std::string user_sql;
+struct DojoLoadTasksData : public TableFunctionData {
+	std::string path;
 };
 
-static unique_ptr<FunctionData> DojoCheckBind(ClientContext &context, TableFunctionBindInput &input,
-                                             vector<LogicalType> &return_types, vector<string> &names) {
+static unique_ptr<FunctionData> DojoLoadTasksBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
 	(void)context;
-	if (input.inputs.size() != 2) {
-		throw InvalidInputException("dojo_check requires 2 arguments: task_id (INTEGER), user_sql (VARCHAR)");
-	}
-	auto task_id = input.inputs[0].GetValue<int32_t>();
-	auto user_sql = input.inputs[1].ToString();
-
-	auto task = FindTask(task_id);
-	if (!task) {
-		throw InvalidInputException("Unknown task_id %d. Try: SELECT * FROM dojo_tasks();", task_id);
+	if (input.inputs.size() != 1 || input.inputs[0].IsNull()) {
+		throw InvalidInputException("dojo_load_tasks requires 1 argument: path (VARCHAR)");
 	}
-
 	return_types = {
-	    LogicalType::BOOLEAN, // ok
-	    LogicalType::VARCHAR, // message
-	    LogicalType::UBIGINT, // expected_rows
-	    LogicalType::UBIGINT  // actual_rows
+	    LogicalType::UBIGINT, // loaded: tasks read from the packs
+	    LogicalType::UBIGINT  // total: tasks in the new catalog, built-in levels and earlier packs included
 	};
-	names = {"ok", "message", "expected_rows", "actual_rows"};
+	names = {"loaded", "total"};
 
-	auto state = make_uniq<DojoCheckState>();
-	state->task_id = task_id;
-	state->user_sql = user_sql;
-	return state;
+	auto bind_data = make_uniq<DojoLoadTasksData>();
+	bind_data->path = input.inputs[0].ToString();
+	return std::move(bind_data);
 }
 
-static void DojoCheckFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-	auto &state = data_p.bind_data->Cast<DojoCheckState>();
-	auto task = FindTask(state.task_id);
-	D_ASSERT(task);
-
-	bool ok = false;
-	std::string message;
-
-	try {
-		Connection con(*context.db);
+static void DojoLoadTasksFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind_data = data_p.bind_data->Cast<DojoLoadTasksData>();
+	auto &gstate = data_p.global_state->Cast<DojoSingleRowState>();
+	if (gstate.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	gstate.done = true;
 
-		EnsureDucklings(con);
+	// A directory loads every *.json pack in it; anything else is handed to read_json as a file name or glob
+	auto &fs = FileSystem::GetFileSystem(context);
+	auto glob = bind_data.path;
+	if (fs.DirectoryExists(glob)) {
+		glob = fs.JoinPath(glob, "*.json");
+	}
+	Connection con(*context.db);
+	auto pack_tasks = ReadTaskPacks(con, glob);
 
-		std::string err;
-		auto expected_res = SafeQuery(con, task->expected_sql, err);
-		if (!expected_res) {
-			ok = false;
-			message = "Internal error: failed to compute expected result: " + err;
-		} else {
-			auto expected_mat = Materialize(*expected_res);
-
-			auto actual_res = SafeQuery(con, state.user_sql, err);
-			if (!actual_res) {
-				ok = false;
-				std::ostringstream ss;
-				ss << "Your query failed to run: " << err;
-				ss << " Try: SELECT dojo_hint(" << task->task_id << ", 1);";
-				message = ss.str();
-				MaterializedRows empty;
-				output.SetValue(0, 0, Value::BOOLEAN(ok));
-				output.SetValue(1, 0, Value(message));
-				output.SetValue(2, 0, Value::UBIGINT(expected_mat.rows.size()));
-				output.SetValue(3, 0, Value::UBIGINT(0));
-				output.SetCardinality(1);
-				return;
+	// Pack tasks are merged into the current catalog, replacing tasks (built-in or from earlier packs) with the same
+	// task_id
+	std::unordered_map<int32_t, idx_t> pack_index;
+	for (idx_t i = 0; i < pack_tasks.size(); i++) {
+		if (!pack_index.emplace(pack_tasks[i].task_id, i).second) {
+			throw InvalidInputException("Duplicate task_id %d in task packs '%s'", pack_tasks[i].task_id, glob);
+		}
+	}
+	auto loaded = pack_tasks.size();
+	auto dojo = DojoState::Get(context);
+	idx_t total;
+	while (true) {
+		// Retried if another load swapped the catalog while this one was merging, so neither load is lost
+		auto current = dojo->Catalog();
+		std::vector<DojoTask> tasks;
+		for (auto &task : current->Tasks()) {
+			if (pack_index.find(task.task_id) == pack_index.end()) {
+				tasks.push_back(task);
 			}
+		}
+		tasks.insert(tasks.end(), pack_tasks.begin(), pack_tasks.end());
+		std::sort(tasks.begin(), tasks.end(),
+		          [](const DojoTask &a, const DojoTask &b) { return a.task_id < b.task_id; });
 
-			auto actual_mat = Materialize(*actual_res);
-
-			// Replace actual column names with expected list for shape check against spec,
-			// because the user might not alias, and we want to provide a helpful error.
-			// We still validate names; we don't auto-fix.
-			message = CompareResults(*task, expected_mat, actual_mat, ok);
-
-			output.SetValue(0, 0, Value::BOOLEAN(ok));
-			output.SetValue(1, 0, Value(message));
-			output.SetValue(2, 0, Value::UBIGINT(expected_mat.rows.size()));
-			output.SetValue(3, 0, Value::UBIGINT(actual_mat.rows.size()));
-			output.SetCardinality(1);
-			return;
+		auto catalog = make_shared_ptr<const DojoTaskCatalog>(std::move(tasks));
+		total = catalog->Tasks().size();
+		if (dojo->ReplaceCatalog(current, std::move(catalog))) {
+			break;
 		}
-	} catch (std::exception &ex) {
-		ok = false;
-		message = std::string("Internal exception: ") + ex.what();
 	}
 
-	output.SetValue(0, 0, Value::BOOLEAN(ok));
-	output.SetValue(1, 0, Value(message));
-	output.SetValue(2, 0, Value::UBIGINT(0));
-	output.SetValue(3, 0, Value::UBIGINT(0));
+	output.SetValue(0, 0, Value::UBIGINT(loaded));
+	output.SetValue(1, 0, Value::UBIGINT(total));
 	output.SetCardinality(1);
 }
 
 // -------------------------- extension load --------------------------
 
 static void LoadInternal(ExtensionLoader &loader) {
+	auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+	config.AddExtensionOption("dojo_check_timeout_ms",
+	                          "Wall-clock budget of a dojo check in milliseconds, unless the task sets its own (0 "
+	                          "disables the limit)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(10000));
+	config.AddExtensionOption("dojo_verdict_cache_size",
+	                          "Number of recent submission verdicts that identical submissions reuse (0 disables the "
+	                          "verdict cache)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(4096));
+	config.AddExtensionOption("dojo_plan_equivalence",
+	                          "Pass submissions whose optimized plan matches the canonical one without running them",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(true));
+	config.AddExtensionOption("dojo_sandbox_instances",
+	                          "Number of in-memory sandbox databases that checks run in (0 runs them in this database)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(0));
+	config.AddExtensionOption("dojo_sandbox_threads", "Threads of each sandbox database (0 uses DuckDB's default)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(2));
+	config.AddExtensionOption("dojo_sandbox_memory_limit",
+	                          "Memory limit of each sandbox database, e.g. '1GB' (empty uses DuckDB's default)",
+	                          LogicalType::VARCHAR, Value("1GB"));
+	config.AddExtensionOption("dojo_grading_workers", "Worker threads that grade dojo_submit() submissions",
+	                          LogicalType::UBIGINT, Value::UBIGINT(4));
+	config.AddExtensionOption("dojo_grading_queue_size",
+	                          "Submissions that may wait to be graded before dojo_submit() rejects new ones",
+	                          LogicalType::UBIGINT, Value::UBIGINT(1024));
+	config.AddExtensionOption("dojo_attempt_log",
+	                          "Table that dojo_check and dojo_check_many append graded attempts to, e.g. "
+	                          "'dojo_attempts' (empty disables the attempt log)",
+	                          LogicalType::VARCHAR, Value(""));
+	config.AddExtensionOption("dojo_user", "User name that attempts are logged for", LogicalType::VARCHAR,
+	                          Value("anonymous"));
+
 	// dojo_setup()
-	TableFunction setup_fun("dojo_setup", {}, DojoSetupFunc, DojoSetupBind);
+	TableFunction setup_fun("dojo_setup", {}, DojoSetupFunc, DojoSetupBind, DojoSingleRowInit);
+	setup_fun.named_parameters["scale_factor"] = LogicalType::DOUBLE;
+	setup_fun.named_parameters["seed"] = LogicalType::BIGINT;
 	loader.RegisterFunction(setup_fun);
 
+	// dojo_ducklings(scale_factor := N, seed := S)
+	TableFunction ducklings_fun("dojo_ducklings", {}, DojoDucklingsFunc, DojoDucklingsBind, DojoDucklingsInit);
+	ducklings_fun.named_parameters["scale_factor"] = LogicalType::DOUBLE;
+	ducklings_fun.named_parameters["seed"] = LogicalType::BIGINT;
+	loader.RegisterFunction(ducklings_fun);
+
 	// dojo_tasks()
-	TableFunction tasks_fun("dojo_tasks", {}, DojoTasksFunc, DojoTasksBind);
+	TableFunction tasks_fun("dojo_tasks", {}, DojoTasksFunc, DojoTasksBind, DojoTasksInit);
+	tasks_fun.projection_pushdown = true;
+	tasks_fun.pushdown_complex_filter = DojoTasksPushdownFilter;
 	loader.RegisterFunction(tasks_fun);
 
 	// dojo_hint(task_id, hint_level)
 	ScalarFunction hint_fun("dojo_hint", {LogicalType::INTEGER, LogicalType::INTEGER}, LogicalType::VARCHAR, DojoHintFunc);
 	loader.RegisterFunction(hint_fun);
 
-	// dojo_check(task_id, user_sql)
-	TableFunction check_fun("dojo_check", {LogicalType::INTEGER, LogicalType::VARCHAR}, DojoCheckFunc, DojoCheckBind);
+	// dojo_load_tasks(path)
+	TableFunction load_tasks_fun("dojo_load_tasks", {LogicalType::VARCHAR}, DojoLoadTasksFunc, DojoLoadTasksBind,
+	                             DojoSingleRowInit);
+	loader.RegisterFunction(load_tasks_fun);
+
+	// dojo_check(task_id, user_sql, metrics := false, variants := 0)
+	TableFunction check_fun("dojo_check", {LogicalType::INTEGER, LogicalType::VARCHAR}, DojoCheckFunc, DojoCheckBind,
+	                        DojoSingleRowInit);
+	check_fun.named_parameters["metrics"] = LogicalType::BOOLEAN;
+	check_fun.named_parameters["variants"] = LogicalType::BIGINT;
 	loader.RegisterFunction(check_fun);
+
+	// dojo_profile(task_id, user_sql)
+	TableFunction profile_fun("dojo_profile", {LogicalType::INTEGER, LogicalType::VARCHAR}, DojoProfileFunc,
+	                          DojoProfileBind, DojoProfileInit);
+	loader.RegisterFunction(profile_fun);
+
+	// dojo_diff(task_id, user_sql)
+	TableFunction diff_fun("dojo_diff", {LogicalType::INTEGER, LogicalType::VARCHAR}, DojoDiffFunc, DojoDiffBind,
+	                       DojoDiffInit);
+	loader.RegisterFunction(diff_fun);
+
+	// dojo_check_many((SELECT submission_id, task_id, sql FROM ...))
+	TableFunction check_many_fun("dojo_check_many", {LogicalType::TABLE}, nullptr, DojoCheckManyBind);
+	check_many_fun.in_out_function = DojoCheckManyFunc;
+	loader.RegisterFunction(check_many_fun);
+
+	// dojo_progress(user := current dojo_user)
+	TableFunction progress_fun("dojo_progress", {}, DojoProgressFunc, DojoProgressBind, DojoRowsInit);
+	progress_fun.named_parameters["user"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(progress_fun);
+
+	// dojo_leaderboard()
+	TableFunction leaderboard_fun("dojo_leaderboard", {}, DojoLeaderboardFunc, DojoLeaderboardBind, DojoRowsInit);
+	loader.RegisterFunction(leaderboard_fun);
+
+	// dojo_flush_attempts()
+	TableFunction flush_attempts_fun("dojo_flush_attempts", {}, DojoFlushAttemptsFunc, DojoFlushAttemptsBind,
+	                                 DojoSingleRowInit);
+	loader.RegisterFunction(flush_attempts_fun);
+
+	// dojo_submit(task_id, user_sql, variants := 0)
+	TableFunction submit_fun("dojo_submit", {LogicalType::INTEGER, LogicalType::VARCHAR}, DojoSubmitFunc,
+	                         DojoSubmitBind, DojoSingleRowInit);
+	submit_fun.named_parameters["variants"] = LogicalType::BIGINT;
+	loader.RegisterFunction(submit_fun);
+
+	// dojo_result(ticket, wait := false)
+	TableFunction result_fun("dojo_result", {LogicalType::UBIGINT}, DojoResultFunc, DojoResultBind, DojoRowsInit);
+	result_fun.named_parameters["wait"] = LogicalType::BOOLEAN;
+	loader.RegisterFunction(result_fun);
+
+	// dojo_results(after := sequence)
+	TableFunction results_fun("dojo_results", {}, DojoResultsFunc, DojoResultsBind, DojoRowsInit);
+	results_fun.named_parameters["after"] = LogicalType::UBIGINT;
+	loader.RegisterFunction(results_fun);
+
+	// dojo_cache_stats()
+	TableFunction cache_stats_fun("dojo_cache_stats", {}, DojoCacheStatsFunc, DojoCacheStatsBind, DojoSingleRowInit);
+	loader.RegisterFunction(cache_stats_fun);
+
+	// dojo_stats()
+	TableFunction stats_fun("dojo_stats", {}, DojoStatsFunc, DojoStatsBind, DojoRowsInit);
+	loader.RegisterFunction(stats_fun);
+
+	// dojo_stats_reset()
+	TableFunction stats_reset_fun("dojo_stats_reset", {}, DojoStatsResetFunc, DojoStatsResetBind, DojoSingleRowInit);
+	loader.RegisterFunction(stats_reset_fun);
 }
 
 void DojoExtension::Load(ExtensionLoader &loader) {